@@ -16,21 +16,14 @@ import 'plugins/builtin/smart_search_plugin.dart';
 import 'plugins/builtin/table_plugin.dart';
 import 'plugins/builtin/theme_plugin.dart';
 import 'plugins/plugin_registry.dart';
-import 'screens/log_viewer.dart';
+import 'screens/viewer_windows.dart';
 import 'services/connection_manager.dart';
-import 'services/filter_service.dart';
-import 'services/keybind_registry.dart';
 import 'services/log_store.dart';
-import 'services/query_store.dart';
 import 'services/rpc_service.dart';
-import 'services/session_store.dart';
-import 'services/selection_service.dart';
 import 'services/settings_service.dart';
-import 'services/sticky_state.dart';
-import 'services/time_range_service.dart';
 import 'services/uri_handler.dart';
+import 'services/viewer_window_service.dart';
 import 'services/window_service.dart';
-import 'theme/theme.dart';
 
 // HOW TO ADD A PLUGIN:
 // 1. Create plugin class in plugins/builtin/ (extend LoggerPlugin, mix in EnableablePlugin if needed)
@@ -54,7 +47,8 @@ void main() {
   PluginRegistry.instance.register(HttpFilterPlugin());
   PluginRegistry.instance.register(ThemePlugin());
 
-  runApp(const LoggerApp());
+  // Every native window is a view on this one engine (see ViewerWindows).
+  runWidget(const LoggerApp());
 }
 
 class LoggerApp extends StatefulWidget {
@@ -116,26 +110,17 @@ class _LoggerAppState extends State<LoggerApp> {
 
   @override
   Widget build(BuildContext context) {
+    // App-wide state shared by all windows; per-window services live in
+    // ViewerWindows.
     return MultiProvider(
       providers: [
         ChangeNotifierProvider.value(value: _connectionManager),
-        ChangeNotifierProvider(create: (_) => FilterService()),
-        ChangeNotifierProvider(create: (_) => KeybindRegistry()),
         ChangeNotifierProvider(create: (_) => LogStore()),
-        ChangeNotifierProvider(create: (_) => SessionStore()),
         ChangeNotifierProvider(create: (_) => RpcService()),
-        ChangeNotifierProvider(create: (_) => QueryStore()),
-        ChangeNotifierProvider(create: (_) => SelectionService()),
-        ChangeNotifierProvider(create: (_) => StickyStateService()),
         ChangeNotifierProvider(create: (_) => SettingsService()),
-        ChangeNotifierProvider(create: (_) => TimeRangeService()),
+        ChangeNotifierProvider(create: (_) => ViewerWindowService()),
       ],
-      child: MaterialApp(
-        title: 'Logger',
-        debugShowCheckedModeBanner: false,
-        theme: createLoggerTheme(),
-        home: LogViewerScreen(launchUri: _launchUri),
-      ),
+      child: ViewerWindows(launchUri: _launchUri),
     );
   }
 }
@@ -2,6 +2,7 @@
 library;
 
 import 'log_entry.dart';
+import 'stream_flow.dart';
 
 // ─── Session Info ────────────────────────────────────────────────────
 
@@ -131,6 +132,15 @@ sealed class ServerBroadcast {
         fenceTs: json['fence_ts'] as String?,
       ),
       'subscribe_ack' => const SubscribeAckMessage(),
+      'flow_state' => FlowStateMessage(
+        mode: parseFlowMode(json['mode'] as String?),
+        coalesced: json['coalesced'] as int? ?? 0,
+        withheld:
+            (json['withheld'] as Map<String, dynamic>?)?.map(
+              (k, v) => MapEntry(k, v as int),
+            ) ??
+            const {},
+      ),
       _ => ErrorMessage(message: 'unknown type: $typeStr'),
     };
   }
@@ -237,3 +247,18 @@ class HistoryMessage extends ServerBroadcast {
 class SubscribeAckMessage extends ServerBroadcast {
   const SubscribeAckMessage();
 }
+
+/// Server-side throttling applied to the live stream since the last report.
+class FlowStateMessage extends ServerBroadcast {
+  final FlowMode mode;
+  final int coalesced;
+
+  /// Entries withheld by sampling or summarizing, per severity.
+  final Map<String, int> withheld;
+
+  const FlowStateMessage({
+    this.mode = FlowMode.live,
+    this.coalesced = 0,
+    this.withheld = const {},
+  });
+}
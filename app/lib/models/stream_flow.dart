@@ -0,0 +1,62 @@
+/// Server-side throttling of the live stream, as reported by `flow_state`.
+library;
+
+import 'package:flutter/foundation.dart';
+
+/// How the server currently throttles the live stream for this viewer.
+///
+/// Ordered from least to most aggressive.
+enum FlowMode { live, coalesce, sample, summary }
+
+FlowMode parseFlowMode(String? value) => switch (value) {
+  'coalesce' => FlowMode.coalesce,
+  'sample' => FlowMode.sample,
+  'summary' => FlowMode.summary,
+  _ => FlowMode.live,
+};
+
+/// Accumulated flow-control state across all connections.
+@immutable
+class StreamFlowStats {
+  /// Most aggressive mode of any connection.
+  final FlowMode mode;
+
+  /// Entries the server withheld (sampled or summarized), per severity.
+  final Map<String, int> withheldBySeverity;
+
+  /// Replace/stack updates the server collapsed into a newer version.
+  final int coalesced;
+
+  const StreamFlowStats({
+    this.mode = FlowMode.live,
+    this.withheldBySeverity = const {},
+    this.coalesced = 0,
+  });
+
+  static const StreamFlowStats idle = StreamFlowStats();
+
+  int get withheld => withheldBySeverity.values.fold(0, (a, b) => a + b);
+
+  bool get isThrottled => mode != FlowMode.live;
+
+  /// Whether there is anything worth showing to the user.
+  bool get isVisible => isThrottled || coalesced > 0 || withheld > 0;
+
+  StreamFlowStats add({
+    required FlowMode mode,
+    required Map<String, int> withheld,
+    required int coalesced,
+  }) {
+    if (withheld.isEmpty && coalesced == 0 && mode == this.mode) return this;
+
+    final merged = Map<String, int>.of(withheldBySeverity);
+    for (final MapEntry(:key, :value) in withheld.entries) {
+      merged[key] = (merged[key] ?? 0) + value;
+    }
+    return StreamFlowStats(
+      mode: mode,
+      withheldBySeverity: Map.unmodifiable(merged),
+      coalesced: this.coalesced + coalesced,
+    );
+  }
+}
@@ -136,3 +136,17 @@ class ViewerDataQueryMessage extends ViewerMessage {
     return map;
   }
 }
+
+/// Consumption watermark the server uses to throttle the live stream.
+class ViewerFlowControlMessage extends ViewerMessage {
+  /// Total `event` messages decoded on this connection.
+  final int consumed;
+
+  const ViewerFlowControlMessage({required this.consumed});
+
+  @override
+  Map<String, dynamic> toJson() => {
+    'type': 'flow_control',
+    'consumed': consumed,
+  };
+}
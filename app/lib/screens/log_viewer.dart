@@ -7,10 +7,12 @@ import 'package:provider/provider.dart';
 import '../models/keybind.dart';
 import '../models/server_broadcast.dart';
 import '../models/viewer_message.dart';
+import '../services/capture_service.dart';
 import '../services/connection_manager.dart';
 import '../services/filter_service.dart';
 import '../services/keybind_registry.dart';
 import '../services/log_store.dart';
+import '../services/loki_backfill_service.dart';
 import '../services/query_store.dart';
 import '../services/rpc_service.dart';
 import '../services/selection_service.dart';
@@ -19,6 +21,7 @@ import '../services/settings_service.dart';
 import '../services/time_range_service.dart';
 import '../services/tray_service.dart';
 import '../services/uri_handler.dart';
+import '../services/viewer_window_service.dart';
 import 'log_viewer_body.dart';
 
 /// Main screen — the full log viewer UI.
@@ -29,10 +32,15 @@ class LogViewerScreen extends StatefulWidget {
   /// Optional `logger://` URI to handle on startup (filter/tab/clear).
   final String? launchUri;
 
+  /// Whether this is the main window, which owns the connection, tray and
+  /// capture. Additional windows only read the shared stores.
+  final bool primary;
+
   const LogViewerScreen({
     super.key,
     this.serverUrl = 'ws://localhost:8080/api/v2/stream',
     this.launchUri,
+    this.primary = true,
   });
 
   @override
@@ -47,6 +55,9 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
   bool _landingDelayActive = true;
   Timer? _landingDelayTimer;
   TrayService? _trayService;
+  CaptureService? _captureService;
+  LokiBackfillService? _lokiBackfillService;
+  ViewerWindowService? _viewerWindows;
 
   @override
   void initState() {
@@ -55,9 +66,15 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
     WidgetsBinding.instance.addPostFrameCallback((_) {
       _registerKeybinds();
       _setupQueryStore();
-      _initConnection();
-      _handleLaunchUri();
-      _initTray();
+      if (widget.primary) {
+        _initConnection();
+        _handleLaunchUri();
+        _initTray();
+        _initCapture();
+      } else {
+        _initSessions();
+        _initWindowConfig();
+      }
     });
     _landingDelayTimer = Timer(const Duration(milliseconds: 500), () {
       if (mounted) setState(() => _landingDelayActive = false);
@@ -70,21 +87,89 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
     _messageSub?.cancel();
     _landingDelayTimer?.cancel();
     _trayService?.dispose();
+    _captureService?.dispose();
+    _lokiBackfillService?.dispose();
+    _viewerWindows?.removeListener(_onViewerWindowsChanged);
     super.dispose();
   }
 
   void _initTray() {
     if (_trayService != null) return;
 
+    _lokiBackfillService = LokiBackfillService(
+      logStore: context.read<LogStore>(),
+    );
     _trayService = TrayService(
       connectionManager: context.read<ConnectionManager>(),
       logStore: context.read<LogStore>(),
       timeRangeService: context.read<TimeRangeService>(),
       settings: context.read<SettingsService>(),
+      lokiBackfill: _lokiBackfillService,
+      viewerWindows: context.read<ViewerWindowService?>(),
     );
     _trayService!.start();
   }
 
+  void _initCapture() {
+    if (_captureService != null) return;
+
+    _captureService = CaptureService(
+      connectionManager: context.read<ConnectionManager>(),
+    );
+    _captureService!.start();
+  }
+
+  /// Keep this window's session list current. The main window requests the
+  /// list on session updates; every window picks up the reply.
+  void _initSessions() {
+    final connection = context.read<ConnectionManager>();
+    _messageSub = connection.messages.listen((msg) {
+      if (msg is SessionListMessage) {
+        context.read<SessionStore>().updateSessions(msg.sessions);
+      }
+    });
+    connection.send(const ViewerSessionListMessage());
+  }
+
+  /// Apply the filters requested for this window when it was opened.
+  ///
+  /// The view can appear before the platform reply carrying its id, in which
+  /// case the config shows up shortly after.
+  void _initWindowConfig() {
+    _viewerWindows = context.read<ViewerWindowService?>();
+    if (_viewerWindows == null || _applyWindowConfig()) return;
+    _viewerWindows!.addListener(_onViewerWindowsChanged);
+  }
+
+  void _onViewerWindowsChanged() {
+    if (_applyWindowConfig()) {
+      _viewerWindows?.removeListener(_onViewerWindowsChanged);
+    }
+  }
+
+  bool _applyWindowConfig() {
+    final config = _viewerWindows?.takeConfig(View.of(context).viewId);
+    if (config == null) return false;
+    context.read<FilterService>().loadQuery(
+      severities: config.severities ?? defaultSeverities,
+      textFilter: config.textFilter,
+    );
+    context.read<SessionStore>().selectSessions(config.sessionIds);
+    return true;
+  }
+
+  void _openWindow() {
+    final filters = context.read<FilterService>();
+    context.read<ViewerWindowService?>()?.openWindow(
+      config: ViewerWindowConfig(
+        textFilter: filters.textFilter,
+        severities: Set.of(filters.activeSeverities),
+        sessionIds: Set.of(context.read<SessionStore>().selectedSessionIds),
+      ),
+      decorated: !context.read<SettingsService>().miniMode,
+    );
+  }
+
   void _registerKeybinds() {
     final registry = context.read<KeybindRegistry>();
 
@@ -103,6 +188,21 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
       },
     );
 
+    registry.register(
+      const Keybind(
+        id: 'new_window',
+        label: 'Open new window with current filters',
+        category: 'View',
+        key: LogicalKeyboardKey.keyN,
+        ctrl: true,
+        shift: true,
+      ),
+      () {
+        _openWindow();
+        return true;
+      },
+    );
+
     registry.register(
       const Keybind(
         id: 'copy',
@@ -126,6 +226,8 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
   }
 
   bool _handleKeyEvent(KeyEvent event) {
+    // Key events are global across windows; only the focused one reacts.
+    if (!_hasKeyboardFocus()) return false;
     if (context.read<KeybindRegistry>().handleKeyEvent(event)) return true;
     final selection = context.read<SelectionService>();
     final isShift =
@@ -142,6 +244,12 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
     return false;
   }
 
+  bool _hasKeyboardFocus() {
+    final focused = FocusManager.instance.primaryFocus?.context;
+    if (focused == null) return widget.primary;
+    return View.maybeOf(focused) == View.of(context);
+  }
+
   void _initConnection() {
     final url = widget.serverUrl;
     if (url == null) return;
@@ -149,15 +257,10 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
     final connection = context.read<ConnectionManager>();
     connection.addConnection(url, label: 'Default');
     _messageSub = connection.messages.listen(_handleMessage);
+    // Session selection is per window and applied locally, so the one
+    // subscription covers every session.
     connection.subscribe();
 
-    context.read<SessionStore>().addListener(() {
-      final selected = context.read<SessionStore>().selectedSessionIds;
-      connection.subscribe(
-        sessionIds: selected.isEmpty ? null : selected.toList(),
-      );
-    });
-
     connection.send(const ViewerSessionListMessage());
     connection.queryHistory(limit: 5000);
   }
@@ -190,7 +293,8 @@ class _LogViewerScreenState extends State<LogViewerScreen> {
           ErrorMessage() ||
           RpcRequestMessage() ||
           DataUpdateMessage() ||
-          SubscribeAckMessage():
+          SubscribeAckMessage() ||
+          FlowStateMessage():
         break;
     }
   }
@@ -0,0 +1,109 @@
+import 'dart:ui' show FlutterView;
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/material.dart';
+import 'package:provider/provider.dart';
+
+import '../services/filter_service.dart';
+import '../services/keybind_registry.dart';
+import '../services/query_store.dart';
+import '../services/selection_service.dart';
+import '../services/session_store.dart';
+import '../services/sticky_state.dart';
+import '../services/time_range_service.dart';
+import '../theme/theme.dart';
+import 'log_viewer.dart';
+
+/// One log viewer per Flutter view (native window).
+///
+/// The implicit view is the main window and owns the connection, tray and
+/// capture. Views opened later through `ViewerWindowService` render from the
+/// same shared stores and only get their own filters, session selection,
+/// entry selection, bookmarks and keybinds.
+class ViewerWindows extends StatefulWidget {
+  /// Optional `logger://` URI handled by the main window on startup.
+  final String? launchUri;
+
+  const ViewerWindows({super.key, this.launchUri});
+
+  @override
+  State<ViewerWindows> createState() => _ViewerWindowsState();
+}
+
+class _ViewerWindowsState extends State<ViewerWindows>
+    with WidgetsBindingObserver {
+  List<FlutterView> _views = const [];
+
+  @override
+  void initState() {
+    super.initState();
+    _views = _currentViews();
+    WidgetsBinding.instance.addObserver(this);
+  }
+
+  @override
+  void dispose() {
+    WidgetsBinding.instance.removeObserver(this);
+    super.dispose();
+  }
+
+  // Views are added and removed through metrics changes.
+  @override
+  void didChangeMetrics() {
+    final views = _currentViews();
+    if (!listEquals(views, _views)) setState(() => _views = views);
+  }
+
+  List<FlutterView> _currentViews() =>
+      WidgetsBinding.instance.platformDispatcher.views.toList();
+
+  @override
+  Widget build(BuildContext context) {
+    final implicitViewId =
+        WidgetsBinding.instance.platformDispatcher.implicitView?.viewId;
+
+    return ViewCollection(
+      views: [
+        for (final view in _views)
+          View(
+            key: ValueKey(view.viewId),
+            view: view,
+            child: _ViewerWindow(
+              primary: view.viewId == implicitViewId,
+              launchUri: widget.launchUri,
+            ),
+          ),
+      ],
+    );
+  }
+}
+
+class _ViewerWindow extends StatelessWidget {
+  final bool primary;
+  final String? launchUri;
+
+  const _ViewerWindow({required this.primary, this.launchUri});
+
+  @override
+  Widget build(BuildContext context) {
+    return MultiProvider(
+      providers: [
+        ChangeNotifierProvider(create: (_) => FilterService()),
+        ChangeNotifierProvider(create: (_) => KeybindRegistry()),
+        ChangeNotifierProvider(create: (_) => QueryStore()),
+        ChangeNotifierProvider(create: (_) => SelectionService()),
+        ChangeNotifierProvider(create: (_) => SessionStore()),
+        ChangeNotifierProvider(create: (_) => StickyStateService()),
+        ChangeNotifierProvider(create: (_) => TimeRangeService()),
+      ],
+      child: MaterialApp(
+        title: 'Logger',
+        debugShowCheckedModeBanner: false,
+        theme: createLoggerTheme(),
+        home: primary
+            ? LogViewerScreen(launchUri: launchUri)
+            : const LogViewerScreen(serverUrl: null, primary: false),
+      ),
+    );
+  }
+}
@@ -0,0 +1,153 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+import 'connection_manager.dart';
+
+abstract interface class CapturePlatformApi {
+  /// Signal that the Dart side can receive capture/replay calls.
+  Future<void> ready();
+
+  /// Hand raw frames with their monotonic receive timestamps to the native
+  /// capture writer.
+  Future<void> sendFrames({
+    required Int64List timestamps,
+    required List<String> frames,
+  });
+}
+
+class MethodChannelCapturePlatformApi implements CapturePlatformApi {
+  final MethodChannel _channel;
+
+  const MethodChannelCapturePlatformApi(this._channel);
+
+  @override
+  Future<void> ready() async {
+    await _channel.invokeMethod('ready');
+  }
+
+  @override
+  Future<void> sendFrames({
+    required Int64List timestamps,
+    required List<String> frames,
+  }) async {
+    await _channel.invokeMethod('frames', {
+      'timestamps': timestamps,
+      'frames': frames,
+    });
+  }
+}
+
+/// Bridges raw `/api/v2/stream` frames to the native capture writer, and
+/// feeds replayed captures back into [ConnectionManager].
+///
+/// Capture and replay are driven natively (tray menu, `--replay=` flag);
+/// this service only moves frames across the channel.
+class CaptureService {
+  static const MethodChannel _channel = MethodChannel('com.logger/capture');
+
+  /// Frames are forwarded in batches to keep channel traffic low.
+  static const int maxBatchFrames = 256;
+  static const Duration flushInterval = Duration(milliseconds: 50);
+
+  final ConnectionManager connectionManager;
+  final CapturePlatformApi _platform;
+
+  final Stopwatch _clock = Stopwatch()..start();
+  final List<int> _pendingTimestamps = [];
+  final List<String> _pendingFrames = [];
+  Timer? _flushTimer;
+  bool _capturing = false;
+  bool _started = false;
+
+  CaptureService({
+    required this.connectionManager,
+    CapturePlatformApi? platform,
+  }) : _platform = platform ?? const MethodChannelCapturePlatformApi(_channel);
+
+  bool get capturing => _capturing;
+
+  Future<void> start() async {
+    if (_started) return;
+    _started = true;
+
+    _channel.setMethodCallHandler(handleMethodCall);
+    try {
+      await _platform.ready();
+    } on MissingPluginException {
+      // Capture is only implemented by the Linux runner.
+    }
+  }
+
+  Future<void> dispose() async {
+    if (!_started) return;
+    _started = false;
+
+    await _setCapturing(false);
+    _channel.setMethodCallHandler(null);
+  }
+
+  @visibleForTesting
+  Future<void> handleMethodCall(MethodCall call) async {
+    switch (call.method) {
+      // Native closes the capture file once this call returns, so a stop
+      // only completes after the last frames have been handed over.
+      case 'setCapturing':
+        final capturing = call.arguments;
+        if (capturing is bool) await _setCapturing(capturing);
+      case 'replayFrames':
+        final frames = call.arguments;
+        if (frames is! List) return;
+        for (final frame in frames) {
+          if (frame is Uint8List) {
+            connectionManager.ingestRawFrame(
+              utf8.decode(frame, allowMalformed: true),
+            );
+          }
+        }
+    }
+  }
+
+  Future<void> _setCapturing(bool capturing) async {
+    if (_capturing == capturing) return;
+    _capturing = capturing;
+
+    if (capturing) {
+      connectionManager.rawFrameTap = _onRawFrame;
+    } else {
+      connectionManager.rawFrameTap = null;
+      await _flush();
+    }
+  }
+
+  void _onRawFrame(String frame) {
+    _pendingTimestamps.add(_clock.elapsedMicroseconds);
+    _pendingFrames.add(frame);
+
+    if (_pendingFrames.length >= maxBatchFrames) {
+      unawaited(_flush());
+    } else {
+      _flushTimer ??= Timer(flushInterval, _flush);
+    }
+  }
+
+  Future<void> _flush() async {
+    _flushTimer?.cancel();
+    _flushTimer = null;
+    if (_pendingFrames.isEmpty) return;
+
+    final timestamps = Int64List.fromList(_pendingTimestamps);
+    final frames = List<String>.of(_pendingFrames);
+    _pendingTimestamps.clear();
+    _pendingFrames.clear();
+
+    try {
+      await _platform.sendFrames(timestamps: timestamps, frames: frames);
+    } catch (e) {
+      debugPrint('[CaptureService] frame forward failed: $e');
+    }
+  }
+}
@@ -7,6 +7,7 @@ import 'package:web_socket_channel/web_socket_channel.dart';
 
 import '../models/server_broadcast.dart';
 import '../models/server_connection.dart';
+import '../models/stream_flow.dart';
 import '../models/viewer_message.dart';
 
 part 'connection_reconnect.dart';
@@ -15,10 +16,22 @@ part 'connection_reconnect.dart';
 class ConnectionManager extends ChangeNotifier with _ConnectionLifecycle {
   @override
   final Map<String, _ActiveConnection> _connections = {};
-  @override
   final StreamController<ServerBroadcast> _messageController =
       StreamController<ServerBroadcast>.broadcast();
 
+  /// How often consumption is reported to servers while events flow.
+  static const Duration flowReportInterval = Duration(milliseconds: 250);
+
+  /// Server-side sampling of the live stream, for the status bar.
+  ///
+  /// Kept separate from [notifyListeners] so per-flush updates during a
+  /// burst don't rebuild everything that watches the connection list.
+  final ValueNotifier<StreamFlowStats> flowStats = ValueNotifier(
+    StreamFlowStats.idle,
+  );
+
+  Timer? _flowReportTimer;
+
   // ─── Public API ─────────────────────────────────────────────────
 
   Map<String, ServerConnection> get connections =>
@@ -29,6 +42,18 @@ class ConnectionManager extends ChangeNotifier with _ConnectionLifecycle {
 
   Stream<ServerBroadcast> get messages => _messageController.stream;
 
+  /// Called with every raw frame received from a server, before decoding.
+  ///
+  /// Left null unless a consumer (e.g. stream capture) needs the raw frames.
+  @override
+  void Function(String frame)? rawFrameTap;
+
+  /// Decode a raw frame and publish it as if a server had sent it.
+  ///
+  /// Used to replay captured traffic through the normal ingest path; the
+  /// frame is not passed to [rawFrameTap].
+  void ingestRawFrame(String frame) => _decodeFrame('replay', frame);
+
   /// Add a new server connection and optionally connect immediately.
   String addConnection(String url, {String? label, bool connect = true}) {
     final id = DateTime.now().microsecondsSinceEpoch.toString();
@@ -100,12 +125,79 @@ class ConnectionManager extends ChangeNotifier with _ConnectionLifecycle {
 
   bool get isConnected => activeCount > 0;
 
+  // ─── Flow control ───────────────────────────────────────────────
+
+  @override
+  void _publish(ServerBroadcast message) => _messageController.add(message);
+
+  @override
+  void _trackFlow(String id, ServerBroadcast message) {
+    // Replayed frames have no connection; their flow_state still counts.
+    final flow = _connections[id]?.flow;
+
+    switch (message) {
+      case EventBroadcast():
+        if (flow == null) return;
+        flow.consumed++;
+        _flowReportTimer ??= Timer.periodic(
+          flowReportInterval,
+          (_) => _reportFlow(),
+        );
+      case FlowStateMessage(:final mode, :final withheld, :final coalesced):
+        flow?.mode = mode;
+        flowStats.value = flowStats.value.add(
+          mode: flow == null ? mode : _worstFlowMode(),
+          withheld: withheld,
+          coalesced: coalesced,
+        );
+      default:
+        break;
+    }
+  }
+
+  /// Report consumption to every server that sent events since the last
+  /// report; stops once all streams are idle.
+  void _reportFlow() {
+    var reported = false;
+    for (final MapEntry(:key, :value) in _connections.entries) {
+      final flow = value.flow;
+      if (value.channel == null || flow.consumed == flow.reported) continue;
+      flow.reported = flow.consumed;
+      send(
+        ViewerFlowControlMessage(consumed: flow.consumed),
+        connectionId: key,
+      );
+      reported = true;
+    }
+
+    if (!reported) {
+      _flowReportTimer?.cancel();
+      _flowReportTimer = null;
+      // Connections may have been replaced since the last flow_state.
+      flowStats.value = flowStats.value.add(
+        mode: _worstFlowMode(),
+        withheld: const {},
+        coalesced: 0,
+      );
+    }
+  }
+
+  FlowMode _worstFlowMode() {
+    var worst = FlowMode.live;
+    for (final conn in _connections.values) {
+      if (conn.flow.mode.index > worst.index) worst = conn.flow.mode;
+    }
+    return worst;
+  }
+
   @override
   void dispose() {
+    _flowReportTimer?.cancel();
     for (final id in _connections.keys.toList()) {
       _disconnect(id);
     }
     _messageController.close();
+    flowStats.dispose();
     super.dispose();
   }
 }
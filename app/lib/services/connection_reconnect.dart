@@ -1,38 +1,60 @@
 part of 'connection_manager.dart';
 
+/// Per-socket flow-control counters; reset whenever the socket is replaced.
+class _FlowCounters {
+  /// `event` messages decoded on this socket.
+  int consumed = 0;
+
+  /// [consumed] as of the last `flow_control` report.
+  int reported = 0;
+
+  /// Throttling mode last announced by the server.
+  FlowMode mode = FlowMode.live;
+}
+
 /// Internal wrapper for connection state + channel + timers.
 class _ActiveConnection {
   final ServerConnection config;
   final WebSocketChannel? channel;
   final StreamSubscription<dynamic>? subscription;
   final Timer? reconnectTimer;
+  final _FlowCounters flow;
 
   _ActiveConnection({
     required this.config,
     this.channel,
     this.subscription,
     this.reconnectTimer,
-  });
+    _FlowCounters? flow,
+  }) : flow = flow ?? _FlowCounters();
 
   _ActiveConnection withConfig(ServerConnection newConfig) => _ActiveConnection(
     config: newConfig,
     channel: channel,
     subscription: subscription,
     reconnectTimer: reconnectTimer,
+    flow: flow,
   );
 }
 
 /// Connection lifecycle management (connect, disconnect, reconnect).
 mixin _ConnectionLifecycle on ChangeNotifier {
   Map<String, _ActiveConnection> get _connections;
-  StreamController<ServerBroadcast> get _messageController;
+  void Function(String frame)? get rawFrameTap;
+  void _trackFlow(String id, ServerBroadcast message);
+  void _publish(ServerBroadcast message);
 
   Future<void> _connect(String id) async {
     final conn = _connections[id];
     if (conn == null) return;
 
-    _connections[id] = conn.withConfig(
-      conn.config.copyWith(state: ServerConnectionState.connecting),
+    // A new socket is a new viewer to the server, which counts sent events
+    // from zero; start the consumed count there too.
+    _connections[id] = _ActiveConnection(
+      config: conn.config.copyWith(state: ServerConnectionState.connecting),
+      channel: conn.channel,
+      subscription: conn.subscription,
+      reconnectTimer: conn.reconnectTimer,
     );
     notifyListeners();
 
@@ -66,6 +88,7 @@ mixin _ConnectionLifecycle on ChangeNotifier {
         ),
         channel: channel,
         subscription: sub,
+        flow: current.flow,
       );
       notifyListeners();
     } catch (e) {
@@ -94,9 +117,16 @@ mixin _ConnectionLifecycle on ChangeNotifier {
   }
 
   void _onData(String id, dynamic data) {
+    if (data is String) rawFrameTap?.call(data);
+    _decodeFrame(id, data);
+  }
+
+  void _decodeFrame(String id, dynamic data) {
     try {
       final json = jsonDecode(data as String) as Map<String, dynamic>;
-      _messageController.add(ServerBroadcast.fromJson(json));
+      final message = ServerBroadcast.fromJson(json);
+      _trackFlow(id, message);
+      _publish(message);
     } catch (e) {
       debugPrint('ConnectionManager[$id]: parse error: $e');
     }
@@ -11,12 +11,27 @@ class LogStore extends ChangeNotifier {
   final List<LogEntry> _entries = [];
   final Map<String, int> _idIndex = {};
   final Map<String, Map<String, dynamic>> _stateStore = {};
+
+  /// Timestamp of the entry that last set or removed each state key, so
+  /// history loaded after the fact cannot overwrite newer state.
+  final Map<String, Map<String, DateTime>> _stateUpdatedAt = {};
   final StackManager _stacking = StackManager();
   int _version = 0;
+  int _ingestedCount = 0;
+  int _ingestedErrorCount = 0;
 
   /// Monotonically increasing version number, incremented on each mutation.
   int get version => _version;
 
+  /// Live entries received through [addEntry] since startup, including
+  /// replaced and stacked versions. History loaded through [addEntries] or
+  /// [insertHistorical] is not counted. Not reset by [clear]; used for
+  /// throughput statistics.
+  int get ingestedCount => _ingestedCount;
+
+  /// Error and critical entries among [ingestedCount].
+  int get ingestedErrorCount => _ingestedErrorCount;
+
   /// All log entries in insertion order.
   List<LogEntry> get entries => List.unmodifiable(_entries);
 
@@ -45,6 +60,7 @@ class LogStore extends ChangeNotifier {
 
   /// Add a single log entry, handling replace/upsert by id and stacking.
   void addEntry(LogEntry entry) {
+    _countIngested(entry);
     _updateState(entry);
 
     final stackResult = _stacking.processEntry(entry, _entries, _idIndex);
@@ -69,7 +85,7 @@ class LogStore extends ChangeNotifier {
     notifyListeners();
   }
 
-  /// Add multiple entries at once (batch).
+  /// Add multiple entries at once (batch), e.g. a history page.
   void addEntries(List<LogEntry> entries) {
     for (final entry in entries) {
       _updateState(entry);
@@ -108,7 +124,7 @@ class LogStore extends ChangeNotifier {
     _stacking.initHistoricalStacks(toInsert);
 
     for (final entry in toInsert) {
-      _updateState(entry);
+      _updateState(entry, historical: true);
     }
 
     _evictIfNeeded();
@@ -117,9 +133,31 @@ class LogStore extends ChangeNotifier {
     return toInsert.length;
   }
 
+  void _countIngested(LogEntry entry) {
+    _ingestedCount++;
+    if (entry.severity.index >= Severity.error.index) _ingestedErrorCount++;
+  }
+
   /// Handle state updates for a single entry.
-  void _updateState(LogEntry entry) {
+  ///
+  /// Live entries always apply. Historical entries arrive out of order
+  /// (backfill delivers newest chunks first) and only apply when they are
+  /// not older than what already set the key.
+  void _updateState(LogEntry entry, {bool historical = false}) {
     if (entry.kind == EntryKind.data && entry.key != null) {
+      // Parsed, since ISO strings with different offsets or precision do
+      // not sort chronologically.
+      final timestamp = DateTime.tryParse(entry.timestamp);
+      final updatedAt = _stateUpdatedAt.putIfAbsent(entry.sessionId, () => {});
+      final previous = updatedAt[entry.key!];
+      if (historical &&
+          timestamp != null &&
+          previous != null &&
+          timestamp.isBefore(previous)) {
+        return;
+      }
+      if (timestamp != null) updatedAt[entry.key!] = timestamp;
+
       _stateStore.putIfAbsent(entry.sessionId, () => {});
       if (entry.value == null) {
         _stateStore[entry.sessionId]!.remove(entry.key);
@@ -154,6 +192,7 @@ class LogStore extends ChangeNotifier {
     _entries.clear();
     _idIndex.clear();
     _stateStore.clear();
+    _stateUpdatedAt.clear();
     _stacking.clear();
     _version++;
     notifyListeners();
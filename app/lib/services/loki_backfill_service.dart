@@ -0,0 +1,193 @@
+import 'dart:async';
+import 'dart:convert';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+import '../models/log_entry.dart';
+import 'log_store.dart';
+
+abstract interface class LokiBackfillPlatformApi {
+  /// Start a native backfill; a running one is superseded.
+  Future<void> backfill({
+    required int id,
+    required String lokiUrl,
+    required String query,
+    required int startMs,
+    required int endMs,
+  });
+
+  Future<void> cancel();
+}
+
+class MethodChannelLokiBackfillPlatformApi implements LokiBackfillPlatformApi {
+  final MethodChannel _channel;
+
+  const MethodChannelLokiBackfillPlatformApi(this._channel);
+
+  @override
+  Future<void> backfill({
+    required int id,
+    required String lokiUrl,
+    required String query,
+    required int startMs,
+    required int endMs,
+  }) async {
+    await _channel.invokeMethod('backfill', {
+      'id': id,
+      'lokiUrl': lokiUrl,
+      'query': query,
+      'startMs': startMs,
+      'endMs': endMs,
+    });
+  }
+
+  @override
+  Future<void> cancel() async {
+    await _channel.invokeMethod('cancel');
+  }
+}
+
+/// Loads history straight from Loki through the native backfill engine.
+///
+/// The runner fetches the range as parallel shards and caches settled shards
+/// on disk; this service only turns the delivered lines into [LogEntry]s.
+/// Chunks arrive newest first and are prepended via
+/// [LogStore.insertHistorical]. Once the store holds [LogStore.maxEntries]
+/// the backfill is cancelled, since every older chunk would be evicted
+/// straight away.
+class LokiBackfillService {
+  static const MethodChannel _channel = MethodChannel('com.logger/loki');
+
+  static const String defaultLokiUrl = 'http://127.0.0.1:3100';
+
+  final LogStore logStore;
+  final LokiBackfillPlatformApi _platform;
+
+  int _nextId = 0;
+  int? _activeId;
+  Completer<int>? _completer;
+  int _inserted = 0;
+  bool _started = false;
+
+  LokiBackfillService({
+    required this.logStore,
+    LokiBackfillPlatformApi? platform,
+  }) : _platform =
+           platform ?? const MethodChannelLokiBackfillPlatformApi(_channel);
+
+  bool get running => _activeId != null;
+
+  void start() {
+    if (_started) return;
+    _started = true;
+    _channel.setMethodCallHandler(handleMethodCall);
+  }
+
+  Future<void> dispose() async {
+    if (!_started) return;
+    _started = false;
+
+    _channel.setMethodCallHandler(null);
+    if (running) {
+      _finish(_activeId!);
+      await _platform.cancel().catchError((Object _) {});
+    }
+  }
+
+  /// LogQL query matching what the server writes to Loki.
+  ///
+  /// Streams are only labelled by app, severity and environment; the session
+  /// id is structured metadata, so it is matched by a label filter.
+  @visibleForTesting
+  static String buildQuery({String? sessionId}) {
+    const selector = '{app=~".+"}';
+    if (sessionId == null) return selector;
+    final escaped = sessionId.replaceAll(r'\', r'\\').replaceAll('"', r'\"');
+    return '$selector | session="$escaped"';
+  }
+
+  /// Backfill `[from, to)` into the log store. Completes with the number of
+  /// entries inserted; a superseded backfill completes with its count so far.
+  Future<int> backfill({
+    String lokiUrl = defaultLokiUrl,
+    required DateTime from,
+    required DateTime to,
+    String? sessionId,
+  }) async {
+    start();
+    if (running) _finish(_activeId!);
+
+    final id = ++_nextId;
+    final completer = Completer<int>();
+    _activeId = id;
+    _completer = completer;
+    _inserted = 0;
+
+    try {
+      await _platform.backfill(
+        id: id,
+        lokiUrl: lokiUrl,
+        query: buildQuery(sessionId: sessionId),
+        startMs: from.millisecondsSinceEpoch,
+        endMs: to.millisecondsSinceEpoch,
+      );
+    } on MissingPluginException {
+      // Native backfill is only implemented by the Linux runner.
+      _finish(id);
+    } on PlatformException catch (e) {
+      debugPrint('[LokiBackfillService] backfill rejected: ${e.message}');
+      _finish(id);
+    }
+    return completer.future;
+  }
+
+  @visibleForTesting
+  Future<void> handleMethodCall(MethodCall call) async {
+    final args = call.arguments;
+    if (args is! Map || args['id'] != _activeId || _activeId == null) return;
+
+    switch (call.method) {
+      case 'backfillEntries':
+        final lines = args['lines'];
+        if (lines is List && !_atCapacity()) _insertLines(lines);
+        if (_atCapacity()) await _stopAtCapacity();
+      case 'backfillDone':
+        final error = args['error'];
+        if (error is String) {
+          debugPrint('[LokiBackfillService] backfill incomplete: $error');
+        }
+        _finish(_activeId!);
+    }
+  }
+
+  void _insertLines(List<Object?> lines) {
+    final entries = <LogEntry>[];
+    for (final line in lines) {
+      if (line is! String) continue;
+      try {
+        final json = jsonDecode(line) as Map<String, dynamic>;
+        entries.add(LogEntry.fromJson(json));
+      } catch (_) {
+        // Skip lines that are not stored entries.
+      }
+    }
+    if (entries.isNotEmpty) _inserted += logStore.insertHistorical(entries);
+  }
+
+  bool _atCapacity() => logStore.length >= LogStore.maxEntries;
+
+  Future<void> _stopAtCapacity() async {
+    debugPrint('[LokiBackfillService] log store full, stopping backfill');
+    _finish(_activeId!);
+    await _platform.cancel().catchError((Object _) {});
+  }
+
+  void _finish(int id) {
+    if (id != _activeId) return;
+    _activeId = null;
+    final completer = _completer;
+    _completer = null;
+    completer?.complete(_inserted);
+  }
+}
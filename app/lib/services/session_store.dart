@@ -3,6 +3,9 @@ import 'package:flutter/foundation.dart';
 import '../models/server_broadcast.dart';
 
 /// Manages session state for the viewer.
+///
+/// One store per window: each window keeps its own session selection and
+/// filters the shared log store by it.
 class SessionStore extends ChangeNotifier {
   final Map<String, SessionInfo> _sessions = {};
   final Set<String> _selectedSessionIds = {};
@@ -58,6 +61,15 @@ class SessionStore extends ChangeNotifier {
     notifyListeners();
   }
 
+  /// Replace the selection with [sessionIds].
+  void selectSessions(Iterable<String> sessionIds) {
+    _selectedSessionIds
+      ..clear()
+      ..addAll(sessionIds);
+    _updateSelectedCache();
+    notifyListeners();
+  }
+
   /// Select all known sessions.
   void selectAll() {
     _selectedSessionIds.addAll(_sessions.keys);
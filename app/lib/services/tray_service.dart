@@ -1,3 +1,4 @@
+import 'dart:async';
 import 'dart:convert';
 import 'dart:io';
 
@@ -6,8 +7,10 @@ import 'package:flutter/services.dart';
 
 import 'connection_manager.dart';
 import 'log_store.dart';
+import 'loki_backfill_service.dart';
 import 'settings_service.dart';
 import 'time_range_service.dart';
+import 'viewer_window_service.dart';
 
 @immutable
 class TrayPrefs {
@@ -125,10 +128,44 @@ class FileTrayPrefsStore implements TrayPrefsStore {
   }
 }
 
+/// Desired state of one tray menu item; null fields are left untouched.
+@immutable
+class TrayItemState {
+  final String? label;
+  final bool? enabled;
+  final bool? checked;
+
+  const TrayItemState({this.label, this.enabled, this.checked});
+
+  Map<String, Object> toMap() => {
+    if (label != null) 'label': label!,
+    if (enabled != null) 'enabled': enabled!,
+    if (checked != null) 'checked': checked!,
+  };
+
+  @override
+  bool operator ==(Object other) =>
+      other is TrayItemState &&
+      other.label == label &&
+      other.enabled == enabled &&
+      other.checked == checked;
+
+  @override
+  int get hashCode => Object.hash(label, enabled, checked);
+}
+
 abstract interface class TrayPlatformApi {
-  Future<void> setLabel({required String id, required String label});
-  Future<void> setEnabled({required String id, required bool enabled});
-  Future<void> setChecked({required String id, required bool checked});
+  /// Apply a batch of item states in one round trip; the native side only
+  /// touches items whose state actually differs.
+  Future<void> applyState(Map<String, TrayItemState> items);
+
+  /// Report cumulative ingest counters; the native side derives the rate
+  /// and redraws the tray at its own pace.
+  Future<void> reportStats({
+    required int entries,
+    required int errors,
+    required int connections,
+  });
 }
 
 class MethodChannelTrayPlatformApi implements TrayPlatformApi {
@@ -137,18 +174,23 @@ class MethodChannelTrayPlatformApi implements TrayPlatformApi {
   const MethodChannelTrayPlatformApi(this._channel);
 
   @override
-  Future<void> setLabel({required String id, required String label}) async {
-    await _channel.invokeMethod('setLabel', {'id': id, 'label': label});
-  }
-
-  @override
-  Future<void> setEnabled({required String id, required bool enabled}) async {
-    await _channel.invokeMethod('setEnabled', {'id': id, 'enabled': enabled});
+  Future<void> applyState(Map<String, TrayItemState> items) async {
+    await _channel.invokeMethod('applyState', {
+      'items': {for (final e in items.entries) e.key: e.value.toMap()},
+    });
   }
 
   @override
-  Future<void> setChecked({required String id, required bool checked}) async {
-    await _channel.invokeMethod('setChecked', {'id': id, 'checked': checked});
+  Future<void> reportStats({
+    required int entries,
+    required int errors,
+    required int connections,
+  }) async {
+    await _channel.invokeMethod('reportStats', {
+      'entries': entries,
+      'errors': errors,
+      'connections': connections,
+    });
   }
 }
 
@@ -233,6 +275,14 @@ class TrayService {
 
   static const String grafanaUrl = 'http://127.0.0.1:3000';
 
+  /// History loaded from Loki when the extension is (or gets) enabled.
+  static const Duration lokiBackfillWindow = Duration(hours: 24);
+
+  /// How often ingest counters are sent to the tray (only when changed).
+  static const Duration statsReportInterval = Duration(milliseconds: 500);
+
+  static const String _idWindowNew = 'window.new';
+
   static const String _idDocs = 'connection.docs';
   static const String _idHttpBase = 'connection.http_base';
   static const String _idHttpEvents = 'connection.http_events';
@@ -258,9 +308,13 @@ class TrayService {
   final ClipboardApi _clipboard;
   final TrayPrefsStore? _prefsStore;
   final AdminApi _adminApi;
+  final LokiBackfillService? _lokiBackfill;
+  final ViewerWindowService? _viewerWindows;
 
   TrayPrefs _prefs = TrayPrefs.defaults;
   VoidCallback? _connListener;
+  Timer? _statsTimer;
+  ({int entries, int errors, int connections})? _lastStats;
   bool _started = false;
 
   TrayService({
@@ -273,11 +327,15 @@ class TrayService {
     ClipboardApi? clipboard,
     TrayPrefsStore? prefsStore,
     AdminApi? adminApi,
+    LokiBackfillService? lokiBackfill,
+    ViewerWindowService? viewerWindows,
   }) : _platform = platform ?? const MethodChannelTrayPlatformApi(_channel),
        _urlOpener = urlOpener ?? CommandUrlOpener(settings),
        _clipboard = clipboard ?? const FlutterClipboardApi(),
        _prefsStore = prefsStore ?? FileTrayPrefsStore.createDefault(),
-       _adminApi = adminApi ?? HttpAdminApi();
+       _adminApi = adminApi ?? HttpAdminApi(),
+       _lokiBackfill = lokiBackfill,
+       _viewerWindows = viewerWindows;
 
   bool get lokiEnabled => _prefs.lokiEnabled;
   bool get grafanaEnabled => _prefs.grafanaEnabled;
@@ -297,12 +355,19 @@ class TrayService {
     connectionManager.addListener(_connListener!);
 
     await _syncAllMenuState();
+
+    _statsTimer = Timer.periodic(statsReportInterval, (_) => reportStats());
+
+    if (_prefs.lokiEnabled) _backfillFromLoki();
   }
 
   Future<void> dispose() async {
     if (!_started) return;
     _started = false;
 
+    _statsTimer?.cancel();
+    _statsTimer = null;
+
     if (_connListener != null) {
       connectionManager.removeListener(_connListener!);
       _connListener = null;
@@ -336,8 +401,35 @@ class TrayService {
     };
   }
 
+  /// Send the ingest counters to the tray if they changed since last time.
+  @visibleForTesting
+  Future<void> reportStats() async {
+    final stats = (
+      entries: logStore.ingestedCount,
+      errors: logStore.ingestedErrorCount,
+      connections: connectionManager.activeCount,
+    );
+    if (stats == _lastStats) return;
+    _lastStats = stats;
+
+    try {
+      await _platform.reportStats(
+        entries: stats.entries,
+        errors: stats.errors,
+        connections: stats.connections,
+      );
+    } on MissingPluginException {
+      // No native tray on this platform; stop polling.
+      _statsTimer?.cancel();
+    }
+  }
+
   Future<void> handleAction({required String id, bool? checked}) async {
     switch (id) {
+      case _idWindowNew:
+        await _viewerWindows?.openWindow(decorated: !settings.miniMode);
+        return;
+
       case _idDocs:
         await _urlOpener.openUrl(docsUrl);
         return;
@@ -421,6 +513,8 @@ class TrayService {
     }
 
     await _syncExtensionsMenu();
+
+    if (enabled) _backfillFromLoki();
   }
 
   Future<void> _setGrafanaEnabled(bool enabled) async {
@@ -445,6 +539,20 @@ class TrayService {
     await _syncExtensionsMenu();
   }
 
+  void _backfillFromLoki() {
+    final backfill = _lokiBackfill;
+    if (backfill == null) return;
+
+    final now = DateTime.now();
+    unawaited(
+      backfill.backfill(
+        lokiUrl: 'http://${_activeHostOrDefault()}:3100',
+        from: now.subtract(lokiBackfillWindow),
+        to: now,
+      ),
+    );
+  }
+
   Future<void> _clearStore() async {
     logStore.clear();
     timeRangeService.resetRange();
@@ -456,30 +564,39 @@ class TrayService {
   }
 
   Future<void> _syncAllMenuState() async {
-    await _syncConnectionMenu();
-    await _syncExtensionsMenu();
+    await _platform.applyState({
+      ..._connectionMenuState(),
+      ..._extensionsMenuState(),
+    });
   }
 
   Future<void> _syncConnectionMenu() async {
+    await _platform.applyState(_connectionMenuState());
+  }
+
+  Future<void> _syncExtensionsMenu() async {
+    await _platform.applyState(_extensionsMenuState());
+  }
+
+  Map<String, TrayItemState> _connectionMenuState() {
     final host = _activeHostOrDefault();
     final labels = buildMenuLabels(host: host);
 
-    for (final entry in labels.entries) {
-      await _platform.setLabel(id: entry.key, label: entry.value);
-      await _platform.setEnabled(id: entry.key, enabled: true);
-    }
-
-    await _platform.setEnabled(id: _idDocs, enabled: true);
+    return {
+      for (final entry in labels.entries)
+        entry.key: TrayItemState(label: entry.value, enabled: true),
+      _idDocs: const TrayItemState(enabled: true),
+    };
   }
 
-  Future<void> _syncExtensionsMenu() async {
-    await _platform.setChecked(id: _idExtLoki, checked: _prefs.lokiEnabled);
-
+  Map<String, TrayItemState> _extensionsMenuState() {
     final grafanaEnabled = _prefs.lokiEnabled;
-    await _platform.setEnabled(id: _idExtGrafana, enabled: grafanaEnabled);
-    await _platform.setChecked(
-      id: _idExtGrafana,
-      checked: grafanaEnabled && _prefs.grafanaEnabled,
-    );
+    return {
+      _idExtLoki: TrayItemState(checked: _prefs.lokiEnabled),
+      _idExtGrafana: TrayItemState(
+        enabled: grafanaEnabled,
+        checked: grafanaEnabled && _prefs.grafanaEnabled,
+      ),
+    };
   }
 }
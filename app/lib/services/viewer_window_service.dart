@@ -0,0 +1,79 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Initial filters for an additional viewer window.
+@immutable
+class ViewerWindowConfig {
+  final String textFilter;
+
+  /// Severities to show; null keeps the default set.
+  final Set<String>? severities;
+
+  /// Sessions to show; empty shows all of them.
+  final Set<String> sessionIds;
+
+  const ViewerWindowConfig({
+    this.textFilter = '',
+    this.severities,
+    this.sessionIds = const {},
+  });
+}
+
+abstract interface class ViewerWindowPlatformApi {
+  /// Open a native window with a new view on the running engine.
+  ///
+  /// Returns the Flutter view id of the new window.
+  Future<int?> openView({required bool decorated});
+}
+
+class MethodChannelViewerWindowPlatformApi implements ViewerWindowPlatformApi {
+  final MethodChannel _channel;
+
+  const MethodChannelViewerWindowPlatformApi(this._channel);
+
+  @override
+  Future<int?> openView({required bool decorated}) {
+    return _channel.invokeMethod<int>('openView', {'decorated': decorated});
+  }
+}
+
+/// Opens additional viewer windows.
+///
+/// Every window is a view on the same engine, so all of them read the one
+/// log store and connection manager; only filters, session selection and
+/// entry selection are kept per window. The config requested for a window
+/// is held here, keyed by view id, until that window picks it up.
+class ViewerWindowService extends ChangeNotifier {
+  static const MethodChannel _channel = MethodChannel('com.logger/window');
+
+  final ViewerWindowPlatformApi _platform;
+  final Map<int, ViewerWindowConfig> _pending = {};
+
+  ViewerWindowService({ViewerWindowPlatformApi? platform})
+    : _platform =
+          platform ?? const MethodChannelViewerWindowPlatformApi(_channel);
+
+  /// Open a new window; returns its view id, or null if unsupported.
+  Future<int?> openWindow({
+    ViewerWindowConfig config = const ViewerWindowConfig(),
+    bool decorated = true,
+  }) async {
+    final int? viewId;
+    try {
+      viewId = await _platform.openView(decorated: decorated);
+    } on MissingPluginException {
+      return null;
+    } on PlatformException catch (e) {
+      debugPrint('[ViewerWindowService] openView failed: ${e.message}');
+      return null;
+    }
+    if (viewId == null) return null;
+
+    _pending[viewId] = config;
+    notifyListeners();
+    return viewId;
+  }
+
+  /// Hand over the config requested for [viewId], if any, exactly once.
+  ViewerWindowConfig? takeConfig(int viewId) => _pending.remove(viewId);
+}
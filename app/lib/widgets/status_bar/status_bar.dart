@@ -8,7 +8,7 @@ import '../../theme/constants.dart';
 import 'status_bar_segments.dart';
 
 /// A subtle status bar at the bottom of the app showing entry count,
-/// memory estimate, and connection status.
+/// memory estimate, stream sampling, and connection status.
 class StatusBar extends StatelessWidget {
   const StatusBar({super.key});
 
@@ -57,6 +57,7 @@ class StatusBar extends StatelessWidget {
                 ),
               ],
               const Spacer(),
+              const StreamFlowIndicator(),
               const ConnectionIndicator(),
             ],
           );
@@ -4,6 +4,7 @@ import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
 
 import '../../models/server_connection.dart';
+import '../../models/stream_flow.dart';
 import '../../services/connection_manager.dart';
 import '../../theme/colors.dart';
 import '../../theme/constants.dart';
@@ -171,6 +172,74 @@ class ConnectionIndicatorState extends State<ConnectionIndicator> {
   }
 }
 
+// ─── Stream flow indicator ──────────────────────────────────────────
+
+/// Shows when the server throttles the live stream and how much it
+/// withheld. Hidden while the stream has always been delivered in full.
+class StreamFlowIndicator extends StatelessWidget {
+  const StreamFlowIndicator({super.key});
+
+  @override
+  Widget build(BuildContext context) {
+    return ValueListenableBuilder<StreamFlowStats>(
+      valueListenable: context.read<ConnectionManager>().flowStats,
+      builder: (context, stats, _) {
+        if (!stats.isVisible) return const SizedBox.shrink();
+
+        return Padding(
+          padding: const EdgeInsets.only(right: 12),
+          child: Tooltip(
+            message: _tooltip(stats),
+            child: StatusItem(
+              icon: Icons.filter_alt_outlined,
+              label: _label(stats),
+              isWarning: stats.isThrottled,
+            ),
+          ),
+        );
+      },
+    );
+  }
+
+  static String _label(StreamFlowStats stats) {
+    final parts = <String>[
+      if (stats.isThrottled) _modeLabel(stats.mode),
+      if (stats.withheld > 0)
+        '${_formatCount(stats.withheld)} withheld'
+      else if (stats.coalesced > 0)
+        '${_formatCount(stats.coalesced)} coalesced',
+    ];
+    return parts.join(' \u00b7 ');
+  }
+
+  static String _tooltip(StreamFlowStats stats) {
+    final lines = <String>[
+      stats.isThrottled
+          ? 'Server is throttling the live stream while the viewer catches up.'
+          : 'Live stream was throttled during an earlier burst.',
+      if (stats.coalesced > 0)
+        '${stats.coalesced} updates collapsed into newer versions',
+      for (final MapEntry(:key, :value) in stats.withheldBySeverity.entries)
+        '$value $key entries withheld',
+      'Errors are always delivered.',
+    ];
+    return lines.join('\n');
+  }
+
+  static String _modeLabel(FlowMode mode) => switch (mode) {
+    FlowMode.live => 'live',
+    FlowMode.coalesce => 'coalescing',
+    FlowMode.sample => 'sampling',
+    FlowMode.summary => 'summarizing',
+  };
+
+  static String _formatCount(int count) {
+    if (count < 1000) return '$count';
+    if (count < 1000000) return '${(count / 1000).toStringAsFixed(1)}k';
+    return '${(count / 1000000).toStringAsFixed(1)}M';
+  }
+}
+
 // ─── Sticky status section ──────────────────────────────────────────
 
 /// Shows dismissed/ignored sticky counts with a "Restore all" action.
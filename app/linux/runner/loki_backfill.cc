@@ -0,0 +1,1045 @@
+#include "loki_backfill.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+namespace {
+
+constexpr gint64 kNsPerSecond = G_GINT64_CONSTANT(1000000000);
+
+// Shards are aligned to multiples of this width so overlapping windows reuse
+// the same cached shards.
+constexpr gint64 kShardNs = 15 * 60 * kNsPerSecond;
+constexpr guint kMaxParallelRequests = 6;
+constexpr guint kPageLimit = 5000;
+constexpr guint kChunkEntries = 2000;
+constexpr guint kRequestTimeoutSeconds = 30;
+
+// Shards ending less than this long ago may still receive late entries and
+// are never cached.
+constexpr gint64 kCacheSettleNs = 5 * 60 * kNsPerSecond;
+constexpr guint8 kCacheMagic[8] = {'L', 'G', 'L', 'O', 'K', 'I', 0, 1};
+constexpr guint32 kCacheMaxLineLength = 16 * 1024 * 1024;
+// Least recently used shards are pruned beyond this total size.
+constexpr guint64 kCacheMaxBytes = G_GUINT64_CONSTANT(256) * 1024 * 1024;
+
+constexpr guint kJsonMaxDepth = 64;
+
+void entry_clear(gpointer data) {
+  LokiBackfillEntry* entry = static_cast<LokiBackfillEntry*>(data);
+  g_free(const_cast<gchar*>(entry->line));
+}
+
+GArray* entry_array_new() {
+  GArray* entries = g_array_new(FALSE, FALSE, sizeof(LokiBackfillEntry));
+  g_array_set_clear_func(entries, entry_clear);
+  return entries;
+}
+
+gint entry_compare(gconstpointer a, gconstpointer b) {
+  const gint64 ta = static_cast<const LokiBackfillEntry*>(a)->timestamp_ns;
+  const gint64 tb = static_cast<const LokiBackfillEntry*>(b)->timestamp_ns;
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+// ─── Minimal JSON reader ─────────────────────────────────────────────
+//
+// Just enough JSON to walk a query_range response without building a tree.
+
+struct JsonReader {
+  const gchar* pos;
+  const gchar* end;
+};
+
+void json_skip_ws(JsonReader* reader) {
+  while (reader->pos < reader->end && g_ascii_isspace(*reader->pos)) {
+    reader->pos++;
+  }
+}
+
+// Consumes @c if it is the next non-space character.
+gboolean json_consume(JsonReader* reader, gchar c) {
+  json_skip_ws(reader);
+  if (reader->pos < reader->end && *reader->pos == c) {
+    reader->pos++;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+gboolean json_read_hex4(JsonReader* reader, guint32* value) {
+  if (reader->end - reader->pos < 4) {
+    return FALSE;
+  }
+  guint32 result = 0;
+  for (gint i = 0; i < 4; i++) {
+    const gint digit = g_ascii_xdigit_value(*reader->pos++);
+    if (digit < 0) {
+      return FALSE;
+    }
+    result = (result << 4) | static_cast<guint32>(digit);
+  }
+  *value = result;
+  return TRUE;
+}
+
+// Reads a string into @out, or skips it when @out is %NULL.
+gboolean json_read_string(JsonReader* reader, GString* out) {
+  if (!json_consume(reader, '"')) {
+    return FALSE;
+  }
+
+  while (reader->pos < reader->end) {
+    // Copy plain runs in one go; log lines are mostly unescaped text.
+    const gchar* run = reader->pos;
+    while (reader->pos < reader->end && *reader->pos != '"' && *reader->pos != '\\') {
+      reader->pos++;
+    }
+    if (out != nullptr && reader->pos > run) {
+      g_string_append_len(out, run, reader->pos - run);
+    }
+    if (reader->pos >= reader->end) {
+      return FALSE;
+    }
+
+    const gchar c = *reader->pos++;
+    if (c == '"') {
+      return TRUE;
+    }
+    if (reader->pos >= reader->end) {
+      return FALSE;
+    }
+
+    const gchar escape = *reader->pos++;
+    gchar decoded = 0;
+    switch (escape) {
+      case '"':
+      case '\\':
+      case '/':
+        decoded = escape;
+        break;
+      case 'b':
+        decoded = '\b';
+        break;
+      case 'f':
+        decoded = '\f';
+        break;
+      case 'n':
+        decoded = '\n';
+        break;
+      case 'r':
+        decoded = '\r';
+        break;
+      case 't':
+        decoded = '\t';
+        break;
+      case 'u': {
+        guint32 code_point = 0;
+        if (!json_read_hex4(reader, &code_point)) {
+          return FALSE;
+        }
+        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+          guint32 low = 0;
+          if (reader->end - reader->pos >= 6 && reader->pos[0] == '\\' &&
+              reader->pos[1] == 'u') {
+            reader->pos += 2;
+            if (!json_read_hex4(reader, &low)) {
+              return FALSE;
+            }
+          }
+          code_point = low >= 0xDC00 && low <= 0xDFFF
+                           ? 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00)
+                           : 0xFFFD;
+        } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+          code_point = 0xFFFD;
+        }
+        if (out != nullptr) {
+          g_string_append_unichar(out, code_point);
+        }
+        continue;
+      }
+      default:
+        return FALSE;
+    }
+    if (out != nullptr) {
+      g_string_append_c(out, decoded);
+    }
+  }
+
+  return FALSE;
+}
+
+gboolean json_skip_value(JsonReader* reader, guint depth) {
+  json_skip_ws(reader);
+  if (reader->pos >= reader->end || depth > kJsonMaxDepth) {
+    return FALSE;
+  }
+
+  switch (*reader->pos) {
+    case '"':
+      return json_read_string(reader, nullptr);
+    case '{':
+      reader->pos++;
+      if (json_consume(reader, '}')) {
+        return TRUE;
+      }
+      do {
+        if (!json_read_string(reader, nullptr) || !json_consume(reader, ':') ||
+            !json_skip_value(reader, depth + 1)) {
+          return FALSE;
+        }
+      } while (json_consume(reader, ','));
+      return json_consume(reader, '}');
+    case '[':
+      reader->pos++;
+      if (json_consume(reader, ']')) {
+        return TRUE;
+      }
+      do {
+        if (!json_skip_value(reader, depth + 1)) {
+          return FALSE;
+        }
+      } while (json_consume(reader, ','));
+      return json_consume(reader, ']');
+    default: {
+      // Number, true, false or null.
+      const gchar* start = reader->pos;
+      while (reader->pos < reader->end && strchr(",}] \t\r\n", *reader->pos) == nullptr) {
+        reader->pos++;
+      }
+      return reader->pos > start;
+    }
+  }
+}
+
+// Calls @member with each key of an object; @member must consume the value.
+template <typename MemberFunc>
+gboolean json_read_object(JsonReader* reader, MemberFunc&& member) {
+  if (!json_consume(reader, '{')) {
+    return FALSE;
+  }
+  if (json_consume(reader, '}')) {
+    return TRUE;
+  }
+
+  g_autoptr(GString) key = g_string_new(nullptr);
+  do {
+    g_string_truncate(key, 0);
+    if (!json_read_string(reader, key) || !json_consume(reader, ':') ||
+        !member(key->str)) {
+      return FALSE;
+    }
+  } while (json_consume(reader, ','));
+  return json_consume(reader, '}');
+}
+
+// Calls @element for each array element; @element must consume it.
+template <typename ElementFunc>
+gboolean json_read_array(JsonReader* reader, ElementFunc&& element) {
+  if (!json_consume(reader, '[')) {
+    return FALSE;
+  }
+  if (json_consume(reader, ']')) {
+    return TRUE;
+  }
+
+  do {
+    if (!element()) {
+      return FALSE;
+    }
+  } while (json_consume(reader, ','));
+  return json_consume(reader, ']');
+}
+
+// Reads one `[ "<ns>", "<line>", ...]` stream value.
+gboolean loki_read_value(JsonReader* reader, GArray* out) {
+  if (!json_consume(reader, '[')) {
+    return FALSE;
+  }
+
+  g_autoptr(GString) timestamp = g_string_new(nullptr);
+  g_autoptr(GString) line = g_string_new(nullptr);
+  if (!json_read_string(reader, timestamp) || !json_consume(reader, ',') ||
+      !json_read_string(reader, line)) {
+    return FALSE;
+  }
+  // Newer Loki versions append structured metadata.
+  while (json_consume(reader, ',')) {
+    if (!json_skip_value(reader, 0)) {
+      return FALSE;
+    }
+  }
+  if (!json_consume(reader, ']')) {
+    return FALSE;
+  }
+
+  LokiBackfillEntry entry = {g_ascii_strtoll(timestamp->str, nullptr, 10),
+                             g_strndup(line->str, line->len)};
+  g_array_append_val(out, entry);
+  return TRUE;
+}
+
+// Appends every stream value of a query_range response to @out.
+gboolean loki_parse_response(const gchar* data,
+                             gsize length,
+                             GArray* out,
+                             GError** error) {
+  JsonReader reader = {data, data + length};
+  gboolean success = FALSE;
+
+  const gboolean parsed = json_read_object(&reader, [&](const gchar* key) {
+    if (g_strcmp0(key, "status") == 0) {
+      g_autoptr(GString) status = g_string_new(nullptr);
+      if (!json_read_string(&reader, status)) {
+        return FALSE;
+      }
+      success = g_strcmp0(status->str, "success") == 0;
+      return TRUE;
+    }
+    if (g_strcmp0(key, "data") != 0) {
+      return json_skip_value(&reader, 0);
+    }
+
+    return json_read_object(&reader, [&](const gchar* data_key) {
+      if (g_strcmp0(data_key, "result") != 0) {
+        return json_skip_value(&reader, 0);
+      }
+      return json_read_array(&reader, [&]() {
+        return json_read_object(&reader, [&](const gchar* stream_key) {
+          if (g_strcmp0(stream_key, "values") != 0) {
+            return json_skip_value(&reader, 0);
+          }
+          return json_read_array(&reader,
+                                 [&]() { return loki_read_value(&reader, out); });
+        });
+      });
+    });
+  });
+
+  if (!parsed) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Malformed Loki query_range response");
+    return FALSE;
+  }
+  if (!success) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Loki query_range did not succeed");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+// ─── HTTP ────────────────────────────────────────────────────────────
+
+struct HttpEndpoint {
+  // As written in a URL authority, so IPv6 literals are bracketed.
+  gchar* host;
+  guint16 port;
+  gboolean tls;
+  // Path prefix without trailing slash, e.g. "" or "/loki-proxy".
+  gchar* base_path;
+};
+
+void http_endpoint_clear(HttpEndpoint* endpoint) {
+  g_clear_pointer(&endpoint->host, g_free);
+  g_clear_pointer(&endpoint->base_path, g_free);
+}
+
+gboolean http_endpoint_parse(const gchar* url, HttpEndpoint* endpoint, GError** error) {
+  g_autoptr(GError) parse_error = nullptr;
+  g_autoptr(GUri) uri = g_uri_parse(url, G_URI_FLAGS_NONE, &parse_error);
+  if (uri == nullptr) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                "Invalid Loki URL %s: %s", url, parse_error->message);
+    return FALSE;
+  }
+
+  const gchar* scheme = g_uri_get_scheme(uri);
+  if (g_ascii_strcasecmp(scheme, "http") == 0) {
+    endpoint->tls = FALSE;
+  } else if (g_ascii_strcasecmp(scheme, "https") == 0) {
+    endpoint->tls = TRUE;
+  } else {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                "Unsupported Loki URL: %s", url);
+    return FALSE;
+  }
+
+  const gchar* host = g_uri_get_host(uri);
+  if (host == nullptr || *host == '\0') {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                "Loki URL has no host: %s", url);
+    return FALSE;
+  }
+
+  // -1 when the URL has no port; out of range or non-numeric ports already
+  // failed to parse.
+  const gint port = g_uri_get_port(uri);
+  if (port == 0) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                "Invalid port in Loki URL: %s", url);
+    return FALSE;
+  }
+
+  const gchar* path = g_uri_get_path(uri);
+  gsize path_length = strlen(path);
+  while (path_length > 0 && path[path_length - 1] == '/') {
+    path_length--;
+  }
+
+  // GUri strips the brackets from IPv6 literals; put them back so the host
+  // can be used in the Host header and as a connectable address.
+  endpoint->host =
+      strchr(host, ':') != nullptr ? g_strdup_printf("[%s]", host) : g_strdup(host);
+  endpoint->port = static_cast<guint16>(port > 0 ? port : endpoint->tls ? 443 : 80);
+  endpoint->base_path = g_strndup(path, path_length);
+  return TRUE;
+}
+
+gboolean http_read_bytes(GInputStream* input,
+                         GByteArray* body,
+                         gsize length,
+                         GCancellable* cancellable,
+                         GError** error) {
+  const guint offset = body->len;
+  g_byte_array_set_size(body, offset + length);
+  gsize bytes_read = 0;
+  if (!g_input_stream_read_all(input, body->data + offset, length, &bytes_read,
+                               cancellable, error)) {
+    return FALSE;
+  }
+  if (bytes_read != length) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+                "Truncated HTTP response body");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+// Reads a CRLF-terminated line; end of stream is reported as an error.
+gchar* http_read_line(GDataInputStream* input, GCancellable* cancellable, GError** error) {
+  g_autoptr(GError) local_error = nullptr;
+  gchar* line = g_data_input_stream_read_line(input, nullptr, cancellable, &local_error);
+  if (line == nullptr) {
+    if (local_error != nullptr) {
+      g_propagate_error(error, g_steal_pointer(&local_error));
+    } else {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+                  "Unexpected end of HTTP response");
+    }
+  }
+  return line;
+}
+
+// Minimal blocking HTTP/1.1 GET. Handles fixed-length, chunked and
+// close-delimited bodies, which covers Loki and simple fake endpoints.
+GByteArray* http_get(const HttpEndpoint* endpoint,
+                     const gchar* path_and_query,
+                     GCancellable* cancellable,
+                     GError** error) {
+  g_autoptr(GSocketClient) client = g_socket_client_new();
+  g_socket_client_set_timeout(client, kRequestTimeoutSeconds);
+  g_socket_client_set_tls(client, endpoint->tls);
+
+  g_autoptr(GSocketConnection) connection = g_socket_client_connect_to_host(
+      client, endpoint->host, endpoint->port, cancellable, error);
+  if (connection == nullptr) {
+    return nullptr;
+  }
+
+  g_autofree gchar* request = g_strdup_printf(
+      "GET %s HTTP/1.1\r\n"
+      "Host: %s:%u\r\n"
+      "Accept: application/json\r\n"
+      "Connection: close\r\n"
+      "\r\n",
+      path_and_query, endpoint->host, endpoint->port);
+  if (!g_output_stream_write_all(
+          g_io_stream_get_output_stream(G_IO_STREAM(connection)), request,
+          strlen(request), nullptr, cancellable, error)) {
+    return nullptr;
+  }
+
+  g_autoptr(GDataInputStream) input =
+      g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+  g_data_input_stream_set_newline_type(input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+
+  g_autofree gchar* status_line = http_read_line(input, cancellable, error);
+  if (status_line == nullptr) {
+    return nullptr;
+  }
+  const gchar* status_text = strchr(status_line, ' ');
+  const gint64 status = status_text != nullptr ? g_ascii_strtoll(status_text + 1, nullptr, 10) : 0;
+
+  gint64 content_length = -1;
+  gboolean chunked = FALSE;
+  for (;;) {
+    g_autofree gchar* header = http_read_line(input, cancellable, error);
+    if (header == nullptr) {
+      return nullptr;
+    }
+    if (header[0] == '\0') {
+      break;
+    }
+
+    gchar* separator = strchr(header, ':');
+    if (separator == nullptr) {
+      continue;
+    }
+    *separator = '\0';
+    const gchar* value = g_strstrip(separator + 1);
+    if (g_ascii_strcasecmp(header, "content-length") == 0) {
+      content_length = g_ascii_strtoll(value, nullptr, 10);
+    } else if (g_ascii_strcasecmp(header, "transfer-encoding") == 0) {
+      chunked = strstr(value, "chunked") != nullptr;
+    }
+  }
+
+  GInputStream* body_stream = G_INPUT_STREAM(input);
+  g_autoptr(GByteArray) body = g_byte_array_new();
+  if (chunked) {
+    for (;;) {
+      g_autofree gchar* size_line = http_read_line(input, cancellable, error);
+      if (size_line == nullptr) {
+        return nullptr;
+      }
+      const guint64 size = g_ascii_strtoull(size_line, nullptr, 16);
+      if (size == 0) {
+        break;
+      }
+      if (!http_read_bytes(body_stream, body, size, cancellable, error)) {
+        return nullptr;
+      }
+      g_autofree gchar* chunk_end = http_read_line(input, cancellable, error);
+      if (chunk_end == nullptr) {
+        return nullptr;
+      }
+    }
+  } else if (content_length >= 0) {
+    if (!http_read_bytes(body_stream, body, content_length, cancellable, error)) {
+      return nullptr;
+    }
+  } else {
+    guint8 buffer[64 * 1024];
+    for (;;) {
+      const gssize bytes_read =
+          g_input_stream_read(body_stream, buffer, sizeof(buffer), cancellable, error);
+      if (bytes_read < 0) {
+        return nullptr;
+      }
+      if (bytes_read == 0) {
+        break;
+      }
+      g_byte_array_append(body, buffer, static_cast<guint>(bytes_read));
+    }
+  }
+
+  if (status != 200) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Loki returned HTTP %" G_GINT64_FORMAT ": %.*s", status,
+                static_cast<int>(MIN(body->len, 200)),
+                reinterpret_cast<const gchar*>(body->data));
+    return nullptr;
+  }
+
+  return static_cast<GByteArray*>(g_steal_pointer(&body));
+}
+
+}  // namespace
+
+// One epoch-aligned slice of the requested range.
+struct LokiBackfillShard {
+  gint64 start_ns;
+  gint64 end_ns;
+
+  // Written by a worker under the backfill lock.
+  gboolean ready;
+  GArray* entries;
+  GError* error;
+};
+
+struct _LokiBackfill {
+  gint ref_count;
+
+  HttpEndpoint endpoint;
+  gchar* query;
+  gint64 start_ns;
+  gint64 end_ns;
+  gchar* cache_dir;
+
+  LokiBackfillChunkFunc chunk_func;
+  LokiBackfillDoneFunc done_func;
+  gpointer user_data;
+
+  GMainContext* context;
+  GCancellable* cancellable;
+  GThreadPool* pool;
+  GMutex lock;
+
+  LokiBackfillShard* shards;
+  guint n_shards;
+  guint n_emitted;
+  guint64 n_entries;
+  GError* error;
+  gboolean finished;
+};
+
+static void backfill_unref(gpointer data) {
+  LokiBackfill* self = static_cast<LokiBackfill*>(data);
+  if (!g_atomic_int_dec_and_test(&self->ref_count)) {
+    return;
+  }
+
+  for (guint i = 0; i < self->n_shards; i++) {
+    g_clear_pointer(&self->shards[i].entries, g_array_unref);
+    g_clear_error(&self->shards[i].error);
+  }
+  g_free(self->shards);
+  http_endpoint_clear(&self->endpoint);
+  g_clear_pointer(&self->query, g_free);
+  g_clear_pointer(&self->cache_dir, g_free);
+  g_clear_object(&self->cancellable);
+  g_clear_pointer(&self->context, g_main_context_unref);
+  g_clear_error(&self->error);
+  g_mutex_clear(&self->lock);
+  g_free(self);
+}
+
+// ─── Shard cache ─────────────────────────────────────────────────────
+
+static gchar* backfill_cache_path(LokiBackfill* self, const LokiBackfillShard* shard) {
+  g_autofree gchar* key = g_strdup_printf(
+      "%s:%u%s\n%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT, self->endpoint.host,
+      self->endpoint.port, self->endpoint.base_path, self->query, shard->start_ns,
+      shard->end_ns);
+  g_autofree gchar* digest = g_compute_checksum_for_string(G_CHECKSUM_SHA256, key, -1);
+  g_autofree gchar* name = g_strconcat(digest, ".lgloki", nullptr);
+  return g_build_filename(self->cache_dir, name, nullptr);
+}
+
+// Returns the cached entries, or %NULL if the shard is not (validly) cached.
+static GArray* backfill_cache_read(const gchar* path) {
+  g_autoptr(GFile) file = g_file_new_for_path(path);
+  g_autoptr(GFileInputStream) file_stream = g_file_read(file, nullptr, nullptr);
+  if (file_stream == nullptr) {
+    return nullptr;
+  }
+
+  guint8 magic[sizeof(kCacheMagic)];
+  gsize bytes_read = 0;
+  if (!g_input_stream_read_all(G_INPUT_STREAM(file_stream), magic, sizeof(magic),
+                               &bytes_read, nullptr, nullptr) ||
+      bytes_read != sizeof(magic) || memcmp(magic, kCacheMagic, sizeof(magic)) != 0) {
+    return nullptr;
+  }
+
+  g_autoptr(GZlibDecompressor) decompressor =
+      g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW);
+  g_autoptr(GInputStream) stream = g_converter_input_stream_new(
+      G_INPUT_STREAM(file_stream), G_CONVERTER(decompressor));
+
+  g_autoptr(GArray) entries = entry_array_new();
+  for (;;) {
+    guint8 header[12];
+    if (!g_input_stream_read_all(stream, header, sizeof(header), &bytes_read, nullptr,
+                                 nullptr)) {
+      return nullptr;
+    }
+    if (bytes_read == 0) {
+      break;
+    }
+
+    gint64 timestamp_ns = 0;
+    guint32 length = 0;
+    memcpy(&timestamp_ns, header, sizeof(timestamp_ns));
+    memcpy(&length, header + 8, sizeof(length));
+    timestamp_ns = GINT64_FROM_LE(timestamp_ns);
+    length = GUINT32_FROM_LE(length);
+    if (bytes_read != sizeof(header) || length > kCacheMaxLineLength) {
+      return nullptr;
+    }
+
+    gchar* line = static_cast<gchar*>(g_malloc(length + 1));
+    if (!g_input_stream_read_all(stream, line, length, &bytes_read, nullptr, nullptr) ||
+        bytes_read != length) {
+      g_free(line);
+      return nullptr;
+    }
+    line[length] = '\0';
+
+    LokiBackfillEntry entry = {timestamp_ns, line};
+    g_array_append_val(entries, entry);
+  }
+
+  // The modification time tracks the last use for pruning.
+  g_utime(path, nullptr);
+  return static_cast<GArray*>(g_steal_pointer(&entries));
+}
+
+static void backfill_cache_write(const gchar* path, GArray* entries) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GFile) file = g_file_new_for_path(path);
+  g_autoptr(GFile) parent = g_file_get_parent(file);
+  if (!g_file_make_directory_with_parents(parent, nullptr, &error) &&
+      !g_error_matches(error, G_IO_ERROR, G_IO_ERROR_EXISTS)) {
+    g_warning("Loki cache directory unavailable: %s", error->message);
+    return;
+  }
+  g_clear_error(&error);
+
+  g_autoptr(GFileOutputStream) file_stream = g_file_replace(
+      file, nullptr, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, nullptr, &error);
+  if (file_stream == nullptr ||
+      !g_output_stream_write_all(G_OUTPUT_STREAM(file_stream), kCacheMagic,
+                                 sizeof(kCacheMagic), nullptr, nullptr, &error)) {
+    g_warning("Failed to write Loki cache %s: %s", path, error->message);
+    return;
+  }
+
+  g_autoptr(GZlibCompressor) compressor =
+      g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW, 3);
+  g_autoptr(GOutputStream) stream = g_converter_output_stream_new(
+      G_OUTPUT_STREAM(file_stream), G_CONVERTER(compressor));
+
+  for (guint i = 0; i < entries->len; i++) {
+    const LokiBackfillEntry* entry = &g_array_index(entries, LokiBackfillEntry, i);
+    const gsize length = strlen(entry->line);
+    const gint64 timestamp_le = GINT64_TO_LE(entry->timestamp_ns);
+    const guint32 length_le = GUINT32_TO_LE(static_cast<guint32>(length));
+
+    guint8 header[12];
+    memcpy(header, &timestamp_le, sizeof(timestamp_le));
+    memcpy(header + 8, &length_le, sizeof(length_le));
+    if (!g_output_stream_write_all(stream, header, sizeof(header), nullptr, nullptr,
+                                   &error) ||
+        !g_output_stream_write_all(stream, entry->line, length, nullptr, nullptr,
+                                   &error)) {
+      break;
+    }
+  }
+
+  if (error == nullptr) {
+    g_output_stream_close(stream, nullptr, &error);
+  }
+  if (error != nullptr) {
+    g_warning("Failed to write Loki cache %s: %s", path, error->message);
+    g_output_stream_close(stream, nullptr, nullptr);
+    g_file_delete(file, nullptr, nullptr);
+  }
+}
+
+struct CacheFile {
+  gchar* path;
+  gint64 mtime;
+  guint64 size;
+};
+
+static void cache_file_clear(gpointer data) {
+  g_free(static_cast<CacheFile*>(data)->path);
+}
+
+static gint cache_file_compare_mtime(gconstpointer a, gconstpointer b) {
+  const gint64 a_mtime = static_cast<const CacheFile*>(a)->mtime;
+  const gint64 b_mtime = static_cast<const CacheFile*>(b)->mtime;
+  return a_mtime < b_mtime ? -1 : a_mtime > b_mtime ? 1 : 0;
+}
+
+// Deletes the least recently used shards until the cache fits in
+// kCacheMaxBytes. Runs on its own thread and owns @data, the cache directory.
+static gpointer backfill_cache_prune_thread(gpointer data) {
+  g_autofree gchar* cache_dir = static_cast<gchar*>(data);
+  g_autoptr(GDir) dir = g_dir_open(cache_dir, 0, nullptr);
+  if (dir == nullptr) {
+    return nullptr;
+  }
+
+  g_autoptr(GArray) files = g_array_new(FALSE, FALSE, sizeof(CacheFile));
+  g_array_set_clear_func(files, cache_file_clear);
+  guint64 total = 0;
+  const gchar* name = nullptr;
+  while ((name = g_dir_read_name(dir)) != nullptr) {
+    if (!g_str_has_suffix(name, ".lgloki")) {
+      continue;
+    }
+    g_autofree gchar* path = g_build_filename(cache_dir, name, nullptr);
+    GStatBuf info;
+    if (g_stat(path, &info) != 0) {
+      continue;
+    }
+    CacheFile file = {static_cast<gchar*>(g_steal_pointer(&path)), info.st_mtime,
+                      static_cast<guint64>(info.st_size)};
+    g_array_append_val(files, file);
+    total += file.size;
+  }
+
+  if (total <= kCacheMaxBytes) {
+    return nullptr;
+  }
+
+  g_array_sort(files, cache_file_compare_mtime);
+  for (guint i = 0; i < files->len && total > kCacheMaxBytes; i++) {
+    const CacheFile* file = &g_array_index(files, CacheFile, i);
+    if (g_unlink(file->path) == 0) {
+      total -= file->size;
+    }
+  }
+  return nullptr;
+}
+
+// ─── Fetching ────────────────────────────────────────────────────────
+
+// Fetches a shard page by page. Each page restarts at the last timestamp seen
+// so entries sharing it are neither lost nor duplicated.
+static GArray* backfill_fetch_shard(LokiBackfill* self,
+                                    const LokiBackfillShard* shard,
+                                    GError** error) {
+  g_autofree gchar* query = g_uri_escape_string(self->query, nullptr, FALSE);
+  g_autoptr(GArray) entries = entry_array_new();
+  g_autoptr(GHashTable) boundary_lines =
+      g_hash_table_new_full(g_str_hash, g_str_equal, g_free, nullptr);
+  gint64 boundary_ns = G_MININT64;
+  gint64 page_start_ns = shard->start_ns;
+
+  for (;;) {
+    g_autofree gchar* path = g_strdup_printf(
+        "%s/loki/api/v1/query_range?query=%s&start=%" G_GINT64_FORMAT
+        "&end=%" G_GINT64_FORMAT "&limit=%u&direction=FORWARD",
+        self->endpoint.base_path, query, page_start_ns, shard->end_ns, kPageLimit);
+    g_autoptr(GByteArray) body = http_get(&self->endpoint, path, self->cancellable, error);
+    if (body == nullptr) {
+      return nullptr;
+    }
+
+    g_autoptr(GArray) page = entry_array_new();
+    if (!loki_parse_response(reinterpret_cast<const gchar*>(body->data), body->len,
+                             page, error)) {
+      return nullptr;
+    }
+    // Streams are sorted individually; merge them by timestamp.
+    g_array_sort(page, entry_compare);
+
+    const guint appended_before = entries->len;
+    for (guint i = 0; i < page->len; i++) {
+      LokiBackfillEntry* entry = &g_array_index(page, LokiBackfillEntry, i);
+      if (entry->timestamp_ns == boundary_ns &&
+          g_hash_table_contains(boundary_lines, entry->line)) {
+        continue;
+      }
+      g_array_append_val(entries, *entry);
+      entry->line = nullptr;
+    }
+
+    if (page->len < kPageLimit || entries->len == appended_before) {
+      break;
+    }
+
+    const gint64 last_ns =
+        g_array_index(entries, LokiBackfillEntry, entries->len - 1).timestamp_ns;
+    if (last_ns != boundary_ns) {
+      g_hash_table_remove_all(boundary_lines);
+      boundary_ns = last_ns;
+    }
+    for (guint i = entries->len; i > appended_before; i--) {
+      const LokiBackfillEntry* entry = &g_array_index(entries, LokiBackfillEntry, i - 1);
+      if (entry->timestamp_ns != boundary_ns) {
+        break;
+      }
+      g_hash_table_add(boundary_lines, g_strdup(entry->line));
+    }
+    page_start_ns = boundary_ns;
+  }
+
+  return static_cast<GArray*>(g_steal_pointer(&entries));
+}
+
+static GArray* backfill_load_shard(LokiBackfill* self,
+                                   const LokiBackfillShard* shard,
+                                   GError** error) {
+  const gint64 now_ns = g_get_real_time() * 1000;
+  g_autofree gchar* cache_path = nullptr;
+  if (self->cache_dir != nullptr && shard->end_ns <= now_ns - kCacheSettleNs) {
+    cache_path = backfill_cache_path(self, shard);
+    GArray* cached = backfill_cache_read(cache_path);
+    if (cached != nullptr) {
+      return cached;
+    }
+  }
+
+  GArray* entries = backfill_fetch_shard(self, shard, error);
+  if (entries != nullptr && cache_path != nullptr) {
+    backfill_cache_write(cache_path, entries);
+  }
+  return entries;
+}
+
+// ─── Delivery ────────────────────────────────────────────────────────
+
+// Delivers the part of @shard inside the requested range, newest chunk first.
+static void backfill_emit_shard(LokiBackfill* self, LokiBackfillShard* shard) {
+  // Loki treats `end` inclusively, so an entry on a shard boundary can show
+  // up in both neighbours; clamp to the shard as well as the range.
+  const gint64 start_ns = MAX(self->start_ns, shard->start_ns);
+  const gint64 end_ns = MIN(self->end_ns, shard->end_ns);
+  GArray* entries = shard->entries;
+  guint low = 0;
+  guint high = entries->len;
+  while (low < high &&
+         g_array_index(entries, LokiBackfillEntry, low).timestamp_ns < start_ns) {
+    low++;
+  }
+  while (high > low &&
+         g_array_index(entries, LokiBackfillEntry, high - 1).timestamp_ns >= end_ns) {
+    high--;
+  }
+
+  while (high > low) {
+    const guint chunk_start = high - MIN(high - low, kChunkEntries);
+    self->n_entries += high - chunk_start;
+    self->chunk_func(&g_array_index(entries, LokiBackfillEntry, chunk_start),
+                     high - chunk_start, self->user_data);
+    high = chunk_start;
+  }
+}
+
+static gboolean backfill_shard_ready_cb(gpointer user_data) {
+  LokiBackfill* self = static_cast<LokiBackfill*>(user_data);
+  if (self->finished || g_cancellable_is_cancelled(self->cancellable)) {
+    return G_SOURCE_REMOVE;
+  }
+
+  // Shards are delivered strictly newest to oldest, as soon as each one and
+  // every newer shard have arrived.
+  while (self->n_emitted < self->n_shards) {
+    LokiBackfillShard* shard = &self->shards[self->n_shards - 1 - self->n_emitted];
+    g_mutex_lock(&self->lock);
+    const gboolean ready = shard->ready;
+    g_mutex_unlock(&self->lock);
+    if (!ready) {
+      return G_SOURCE_REMOVE;
+    }
+
+    if (shard->error != nullptr && self->error == nullptr) {
+      self->error = g_error_copy(shard->error);
+    }
+    if (shard->entries != nullptr) {
+      backfill_emit_shard(self, shard);
+      g_clear_pointer(&shard->entries, g_array_unref);
+    }
+    self->n_emitted++;
+  }
+
+  self->finished = TRUE;
+  if (self->done_func != nullptr) {
+    // Our source holds a reference, so the callback may free the backfill.
+    self->done_func(self->n_entries, self->error, self->user_data);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static void backfill_shard_worker(gpointer data, gpointer user_data) {
+  LokiBackfillShard* shard = static_cast<LokiBackfillShard*>(data);
+  LokiBackfill* self = static_cast<LokiBackfill*>(user_data);
+
+  GError* error = nullptr;
+  GArray* entries = nullptr;
+  if (!g_cancellable_set_error_if_cancelled(self->cancellable, &error)) {
+    entries = backfill_load_shard(self, shard, &error);
+  }
+
+  g_mutex_lock(&self->lock);
+  shard->entries = entries;
+  shard->error = error;
+  shard->ready = TRUE;
+  g_mutex_unlock(&self->lock);
+
+  g_atomic_int_inc(&self->ref_count);
+  GSource* source = g_idle_source_new();
+  g_source_set_callback(source, backfill_shard_ready_cb, self, backfill_unref);
+  g_source_attach(source, self->context);
+  g_source_unref(source);
+
+  // Drops the reference taken when the shard was queued.
+  backfill_unref(self);
+}
+
+LokiBackfill* loki_backfill_new(const LokiBackfillOptions* options,
+                                LokiBackfillChunkFunc chunk_func,
+                                LokiBackfillDoneFunc done_func,
+                                gpointer user_data,
+                                GError** error) {
+  g_return_val_if_fail(options != nullptr && chunk_func != nullptr, nullptr);
+
+  if (options->query == nullptr || options->start_ns >= options->end_ns) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                "Backfill needs a query and a non-empty time range");
+    return nullptr;
+  }
+
+  HttpEndpoint endpoint = {};
+  if (!http_endpoint_parse(options->loki_url, &endpoint, error)) {
+    return nullptr;
+  }
+
+  LokiBackfill* self = g_new0(LokiBackfill, 1);
+  self->ref_count = 1;
+  self->endpoint = endpoint;
+  self->query = g_strdup(options->query);
+  self->start_ns = options->start_ns;
+  self->end_ns = options->end_ns;
+  self->cache_dir = g_strdup(options->cache_dir);
+  self->chunk_func = chunk_func;
+  self->done_func = done_func;
+  self->user_data = user_data;
+  self->context = g_main_context_ref_thread_default();
+  self->cancellable = g_cancellable_new();
+  g_mutex_init(&self->lock);
+
+  const gint64 first_shard = options->start_ns / kShardNs;
+  const gint64 last_shard = (options->end_ns - 1) / kShardNs;
+  self->n_shards = static_cast<guint>(last_shard - first_shard + 1);
+  self->shards = g_new0(LokiBackfillShard, self->n_shards);
+  for (guint i = 0; i < self->n_shards; i++) {
+    self->shards[i].start_ns = (first_shard + i) * kShardNs;
+    self->shards[i].end_ns = (first_shard + i + 1) * kShardNs;
+  }
+
+  self->pool = g_thread_pool_new(backfill_shard_worker, self,
+                                 MIN(kMaxParallelRequests, self->n_shards), FALSE,
+                                 error);
+  if (self->pool == nullptr) {
+    backfill_unref(self);
+    return nullptr;
+  }
+
+  if (self->cache_dir != nullptr) {
+    g_thread_unref(g_thread_new("loki-cache-prune", backfill_cache_prune_thread,
+                                g_strdup(self->cache_dir)));
+  }
+
+  // Queue newest shards first; they are delivered first as well. Each queued
+  // shard holds a reference, so workers may outlive loki_backfill_free().
+  for (guint i = self->n_shards; i > 0; i--) {
+    g_atomic_int_inc(&self->ref_count);
+    g_thread_pool_push(self->pool, &self->shards[i - 1], nullptr);
+  }
+  return self;
+}
+
+void loki_backfill_free(LokiBackfill* self) {
+  if (self == nullptr) {
+    return;
+  }
+
+  self->finished = TRUE;
+  g_cancellable_cancel(self->cancellable);
+  // Does not wait for the workers, which may be blocked in a request; queued
+  // shards still run so their references are dropped, but return at once.
+  // Sources they add see `finished` and make no callbacks.
+  g_thread_pool_free(self->pool, FALSE, FALSE);
+  self->pool = nullptr;
+  backfill_unref(self);
+}
+
+gchar* loki_backfill_default_cache_dir() {
+  return g_build_filename(g_get_user_cache_dir(), "logger", "loki", nullptr);
+}
@@ -0,0 +1,101 @@
+#ifndef FLUTTER_LOKI_BACKFILL_H_
+#define FLUTTER_LOKI_BACKFILL_H_
+
+#include <gio/gio.h>
+
+/**
+ * LokiBackfillEntry:
+ * @timestamp_ns: Loki entry timestamp in nanoseconds since the epoch.
+ * @line: the raw log line; only valid for the duration of the callback.
+ */
+typedef struct {
+  gint64 timestamp_ns;
+  const gchar* line;
+} LokiBackfillEntry;
+
+/**
+ * LokiBackfillOptions:
+ * @loki_url: Loki base URL, e.g. `http://127.0.0.1:3100`.
+ * @query: LogQL stream selector.
+ * @start_ns: inclusive start of the range.
+ * @end_ns: exclusive end of the range.
+ * @cache_dir: (allow-none): directory for cached shards, or %NULL to disable
+ *   caching.
+ */
+typedef struct {
+  const gchar* loki_url;
+  const gchar* query;
+  gint64 start_ns;
+  gint64 end_ns;
+  const gchar* cache_dir;
+} LokiBackfillOptions;
+
+typedef struct _LokiBackfill LokiBackfill;
+
+/**
+ * LokiBackfillChunkFunc:
+ * @entries: entries in ascending timestamp order.
+ * @n_entries: number of entries in @entries.
+ * @user_data: user data passed to loki_backfill_new().
+ *
+ * Receives merged entries. Chunks arrive newest first, so prepending each
+ * chunk to a list keeps the list in timestamp order.
+ */
+typedef void (*LokiBackfillChunkFunc)(const LokiBackfillEntry* entries,
+                                      guint n_entries,
+                                      gpointer user_data);
+
+/**
+ * LokiBackfillDoneFunc:
+ * @n_entries: total number of entries delivered.
+ * @error: (allow-none): the first shard error, if any shard failed.
+ * @user_data: user data passed to loki_backfill_new().
+ *
+ * Called once after the last chunk. The backfill may be freed from here.
+ */
+typedef void (*LokiBackfillDoneFunc)(guint64 n_entries,
+                                     const GError* error,
+                                     gpointer user_data);
+
+/**
+ * loki_backfill_new:
+ * @options: what to fetch.
+ * @chunk_func: called on the main context with merged entries.
+ * @done_func: called on the main context once all shards were delivered.
+ * @user_data: user data for the callbacks.
+ * @error: (allow-none): return location for a #GError.
+ *
+ * Splits the range into fixed, epoch-aligned shards and fetches them with
+ * concurrent `query_range` requests. Responses are decoded on worker threads;
+ * shards that lie safely in the past are cached on disk and served from the
+ * cache on later backfills. Starting a backfill prunes the least recently
+ * used shards once the cache exceeds 256 MiB.
+ *
+ * Returns: a new #LokiBackfill, or %NULL if the options are invalid.
+ */
+LokiBackfill* loki_backfill_new(const LokiBackfillOptions* options,
+                                LokiBackfillChunkFunc chunk_func,
+                                LokiBackfillDoneFunc done_func,
+                                gpointer user_data,
+                                GError** error);
+
+/**
+ * loki_backfill_free:
+ * @backfill: a #LokiBackfill.
+ *
+ * Cancels outstanding requests and releases @backfill without waiting for
+ * requests already in flight; workers finish in the background. No callbacks
+ * are made afterwards.
+ */
+void loki_backfill_free(LokiBackfill* backfill);
+
+/**
+ * loki_backfill_default_cache_dir:
+ *
+ * Returns: the shard cache directory in the user cache directory.
+ */
+gchar* loki_backfill_default_cache_dir();
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(LokiBackfill, loki_backfill_free)
+
+#endif  // FLUTTER_LOKI_BACKFILL_H_
@@ -1,5 +1,8 @@
 #include "my_application.h"
 
+#include <cmath>
+#include <cstring>
+
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
 #ifdef GDK_WINDOWING_X11
@@ -15,12 +18,17 @@
 #endif
 
 #include "flutter/generated_plugin_registrant.h"
+#include "loki_backfill.h"
+#include "stream_capture.h"
 
 namespace {
 
 constexpr const char* kTrayChannelName = "com.logger/tray";
+constexpr const char* kCaptureChannelName = "com.logger/capture";
+constexpr const char* kLokiChannelName = "com.logger/loki";
 
 constexpr const char* kTrayActionWindowToggle = "window.toggle";
+constexpr const char* kTrayActionWindowNew = "window.new";
 constexpr const char* kTrayActionConnectionDocs = "connection.docs";
 constexpr const char* kTrayActionConnectionHttpBase = "connection.http_base";
 constexpr const char* kTrayActionConnectionHttpEvents = "connection.http_events";
@@ -32,9 +40,26 @@ constexpr const char* kTrayActionConnectionTcpIngest = "connection.tcp_ingest";
 constexpr const char* kTrayActionExtensionsLoki = "extensions.loki";
 constexpr const char* kTrayActionExtensionsGrafana = "extensions.grafana";
 
+constexpr const char* kTrayActionCaptureStart = "capture.start";
+constexpr const char* kTrayActionCaptureStop = "capture.stop";
+constexpr const char* kTrayActionCaptureReplay = "capture.replay";
+constexpr const char* kTrayActionCaptureReplayFast = "capture.replay_fast";
+constexpr const char* kTrayActionCaptureReplayMax = "capture.replay_max";
+constexpr const char* kTrayActionCaptureReplayStop = "capture.replay_stop";
+
 constexpr const char* kTrayActionClearStore = "store.clear";
 constexpr const char* kTrayActionQuit = "app.quit";
 
+// The stats item and indicator label are redrawn at most this often, however
+// frequently the viewer reports counters.
+constexpr guint kTrayStatsIntervalSeconds = 1;
+// Width hint for the indicator label so the panel does not jitter.
+constexpr const char* kTrayStatsLabelGuide = "999.9k/s";
+
+constexpr const char* kReplayArgument = "--replay=";
+constexpr const char* kReplaySpeedArgument = "--replay-speed=";
+constexpr gdouble kReplayFastSpeed = 10.0;
+
 struct TrayActionData {
   MyApplication* app;
   gchar* id;
@@ -63,6 +88,11 @@ struct _MyApplication {
   char** dart_entrypoint_arguments;
 
   GtkWindow* window;
+  FlView* view;
+  // Additional viewer windows; each hosts a view on the main window's engine.
+  GPtrArray* viewer_windows;
+  // Always-on-top is app-wide, so viewer windows opened later inherit it.
+  gboolean keep_above;
 
   FlMethodChannel* tray_channel;
   AppIndicator* tray_indicator;
@@ -70,6 +100,37 @@ struct _MyApplication {
   GHashTable* tray_items_by_id;
 
   GtkWidget* tray_show_hide_item;
+
+  // Live ingest statistics; counters are cumulative as reported by Dart.
+  GtkWidget* tray_stats_item;
+  guint tray_stats_source_id;
+  gint64 tray_stats_entries;
+  gint64 tray_stats_errors;
+  gint64 tray_stats_connections;
+  gint64 tray_stats_rendered_entries;
+  gint64 tray_stats_rendered_at;
+  gdouble tray_stats_rate;
+  gchar* tray_stats_text;
+  gchar* tray_stats_label;
+
+  FlMethodChannel* capture_channel;
+  gboolean capture_ready;
+  StreamCapture* capture;
+  // Stopped capture kept open until Dart has flushed its last frames.
+  StreamCapture* closing_capture;
+  StreamReplay* replay;
+  // Bumped for every closing capture and replay; replies carry the value
+  // they were sent with, so a late reply cannot match a newer object that
+  // happens to reuse the freed address.
+  guint closing_capture_generation;
+  guint replay_generation;
+  gchar* last_capture_path;
+  gchar* startup_replay_path;
+  gdouble startup_replay_speed;
+
+  FlMethodChannel* loki_channel;
+  LokiBackfill* backfill;
+  gint64 backfill_id;
 };
 
 G_DEFINE_TYPE(MyApplication, my_application, GTK_TYPE_APPLICATION)
@@ -170,6 +231,157 @@ static void tray_check_toggled_cb(GtkCheckMenuItem* menu_item, gpointer user_dat
   tray_invoke_on_action(data->app, data->id, true, checked);
 }
 
+// Sets a check item without echoing an onAction back to Dart.
+static void tray_set_checked_silently(GtkWidget* item, bool checked) {
+  g_object_set_data(G_OBJECT(item), "logger-suppress", GINT_TO_POINTER(1));
+  gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(item), checked);
+  g_object_set_data(G_OBJECT(item), "logger-suppress", GINT_TO_POINTER(0));
+}
+
+static bool tray_item_state_valid(FlValue* state) {
+  if (fl_value_get_type(state) != FL_VALUE_TYPE_MAP) {
+    return false;
+  }
+  FlValue* label = fl_value_lookup_string(state, "label");
+  FlValue* enabled = fl_value_lookup_string(state, "enabled");
+  FlValue* checked = fl_value_lookup_string(state, "checked");
+  return (label == nullptr || fl_value_get_type(label) == FL_VALUE_TYPE_STRING) &&
+         (enabled == nullptr || fl_value_get_type(enabled) == FL_VALUE_TYPE_BOOL) &&
+         (checked == nullptr || fl_value_get_type(checked) == FL_VALUE_TYPE_BOOL);
+}
+
+// Brings one item to its desired state, touching GTK only for properties that
+// differ from what the widget already shows. Returns the number of changes.
+static guint tray_apply_item_state(MyApplication* self, const gchar* id, FlValue* state) {
+  GtkWidget* item = tray_lookup_item(self, id);
+  if (item == nullptr) {
+    g_warning("Tray applyState ignored; unknown id: %s", id);
+    return 0;
+  }
+
+  guint changes = 0;
+
+  FlValue* label_value = fl_value_lookup_string(state, "label");
+  if (label_value != nullptr) {
+    const gchar* label = fl_value_get_string(label_value);
+    if (g_strcmp0(gtk_menu_item_get_label(GTK_MENU_ITEM(item)), label) != 0) {
+      gtk_menu_item_set_label(GTK_MENU_ITEM(item), label);
+      changes++;
+    }
+  }
+
+  FlValue* enabled_value = fl_value_lookup_string(state, "enabled");
+  if (enabled_value != nullptr) {
+    const bool enabled = fl_value_get_bool(enabled_value);
+    if (static_cast<bool>(gtk_widget_get_sensitive(item)) != enabled) {
+      gtk_widget_set_sensitive(item, enabled);
+      changes++;
+    }
+  }
+
+  FlValue* checked_value = fl_value_lookup_string(state, "checked");
+  if (checked_value != nullptr) {
+    if (!GTK_IS_CHECK_MENU_ITEM(item)) {
+      g_warning("Tray applyState checked ignored; id is not check item: %s", id);
+    } else {
+      const bool checked = fl_value_get_bool(checked_value);
+      if (static_cast<bool>(gtk_check_menu_item_get_active(GTK_CHECK_MENU_ITEM(item))) !=
+          checked) {
+        tray_set_checked_silently(item, checked);
+        changes++;
+      }
+    }
+  }
+
+  return changes;
+}
+
+// ─── Tray stats ──────────────────────────────────────────────────────
+
+// Formats a count compactly, e.g. 950, 12.3k, 4.1M.
+static gchar* tray_stats_format_count(gdouble value) {
+  if (value < 1000.0) {
+    return g_strdup_printf("%.0f", value);
+  }
+  if (value < 1000000.0) {
+    return g_strdup_printf("%.1fk", value / 1000.0);
+  }
+  return g_strdup_printf("%.1fM", value / 1000000.0);
+}
+
+static void tray_stats_render(MyApplication* self) {
+  g_autofree gchar* rate = tray_stats_format_count(self->tray_stats_rate);
+  g_autofree gchar* errors =
+      tray_stats_format_count(static_cast<gdouble>(self->tray_stats_errors));
+
+  g_autofree gchar* text = nullptr;
+  if (self->tray_stats_connections == 0) {
+    text = g_strdup("Not connected");
+  } else {
+    text = g_strdup_printf("%s entries/s · %s errors · %" G_GINT64_FORMAT " connected", rate,
+                           errors, self->tray_stats_connections);
+  }
+  if (self->tray_stats_item != nullptr && g_strcmp0(text, self->tray_stats_text) != 0) {
+    gtk_menu_item_set_label(GTK_MENU_ITEM(self->tray_stats_item), text);
+    g_free(self->tray_stats_text);
+    self->tray_stats_text = g_steal_pointer(&text);
+  }
+
+  // The panel label only appears while entries are flowing.
+  g_autofree gchar* label =
+      self->tray_stats_rate > 0 ? g_strdup_printf("%s/s", rate) : g_strdup("");
+  if (self->tray_indicator != nullptr && g_strcmp0(label, self->tray_stats_label) != 0) {
+    app_indicator_set_label(self->tray_indicator, label, kTrayStatsLabelGuide);
+    g_free(self->tray_stats_label);
+    self->tray_stats_label = g_steal_pointer(&label);
+  }
+}
+
+static gboolean tray_stats_tick_cb(gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+
+  const gint64 now = g_get_monotonic_time();
+  // Counters go backwards when the Dart side restarts; treat that as idle.
+  const gint64 delta = MAX(self->tray_stats_entries - self->tray_stats_rendered_entries, 0);
+  const gdouble elapsed =
+      static_cast<gdouble>(now - self->tray_stats_rendered_at) / G_USEC_PER_SEC;
+  const gdouble instant = elapsed > 0 ? static_cast<gdouble>(delta) / elapsed : 0.0;
+
+  // Smooth over reports that straddle a tick.
+  self->tray_stats_rate = (self->tray_stats_rate + instant) / 2.0;
+  if (self->tray_stats_rate < 0.5) {
+    self->tray_stats_rate = 0.0;
+  }
+  self->tray_stats_rendered_entries = self->tray_stats_entries;
+  self->tray_stats_rendered_at = now;
+
+  tray_stats_render(self);
+
+  // Go quiet until the next report once nothing is moving.
+  if (delta == 0 && self->tray_stats_rate == 0.0) {
+    self->tray_stats_source_id = 0;
+    return G_SOURCE_REMOVE;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+// Records counters without touching GTK; the tick redraws at its own pace.
+static void tray_stats_report(MyApplication* self,
+                              gint64 entries,
+                              gint64 errors,
+                              gint64 connections) {
+  if (self->tray_stats_source_id == 0) {
+    self->tray_stats_rendered_entries = self->tray_stats_entries;
+    self->tray_stats_rendered_at = g_get_monotonic_time();
+    self->tray_stats_source_id =
+        g_timeout_add_seconds(kTrayStatsIntervalSeconds, tray_stats_tick_cb, self);
+  }
+
+  self->tray_stats_entries = entries;
+  self->tray_stats_errors = errors;
+  self->tray_stats_connections = connections;
+}
+
 static void tray_method_call_handler(FlMethodChannel* /*channel*/,
                                      FlMethodCall* method_call,
                                      gpointer user_data) {
@@ -189,91 +401,465 @@ static void tray_method_call_handler(FlMethodChannel* /*channel*/,
     fl_method_call_respond(method_call, response, nullptr);
   };
 
-  if (g_strcmp0(method, "setLabel") == 0) {
+  if (g_strcmp0(method, "applyState") == 0) {
+    FlValue* items = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                         ? fl_value_lookup_string(args, "items")
+                         : nullptr;
+    if (items == nullptr || fl_value_get_type(items) != FL_VALUE_TYPE_MAP) {
+      respond_error("bad_args", "Expected {items: map}");
+      return;
+    }
+
+    // Validate the whole batch first so a bad entry never leaves it half applied.
+    const size_t count = fl_value_get_length(items);
+    for (size_t i = 0; i < count; i++) {
+      if (fl_value_get_type(fl_value_get_map_key(items, i)) != FL_VALUE_TYPE_STRING ||
+          !tray_item_state_valid(fl_value_get_map_value(items, i))) {
+        respond_error("bad_args",
+                      "Expected items as {id: {label?: string, enabled?: bool, checked?: bool}}");
+        return;
+      }
+    }
+
+    guint changes = 0;
+    for (size_t i = 0; i < count; i++) {
+      changes += tray_apply_item_state(self, fl_value_get_string(fl_value_get_map_key(items, i)),
+                                       fl_value_get_map_value(items, i));
+    }
+
+    g_autoptr(FlMethodResponse) response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_int(changes)));
+    fl_method_call_respond(method_call, response, nullptr);
+    return;
+  }
+
+  if (g_strcmp0(method, "reportStats") == 0) {
     if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
       respond_error("bad_args", "Expected map arguments");
       return;
     }
-    FlValue* id_value = fl_value_lookup_string(args, "id");
-    FlValue* label_value = fl_value_lookup_string(args, "label");
-    if (id_value == nullptr || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING ||
-        label_value == nullptr || fl_value_get_type(label_value) != FL_VALUE_TYPE_STRING) {
-      respond_error("bad_args", "Expected {id: string, label: string}");
+    FlValue* entries_value = fl_value_lookup_string(args, "entries");
+    FlValue* errors_value = fl_value_lookup_string(args, "errors");
+    FlValue* connections_value = fl_value_lookup_string(args, "connections");
+    if (entries_value == nullptr || fl_value_get_type(entries_value) != FL_VALUE_TYPE_INT ||
+        errors_value == nullptr || fl_value_get_type(errors_value) != FL_VALUE_TYPE_INT ||
+        connections_value == nullptr ||
+        fl_value_get_type(connections_value) != FL_VALUE_TYPE_INT) {
+      respond_error("bad_args", "Expected {entries: int, errors: int, connections: int}");
       return;
     }
 
-    const gchar* id = fl_value_get_string(id_value);
-    const gchar* label = fl_value_get_string(label_value);
-    GtkWidget* item = tray_lookup_item(self, id);
-    if (item == nullptr) {
-      g_warning("Tray setLabel ignored; unknown id: %s", id);
-      respond_success();
-      return;
+    tray_stats_report(self, fl_value_get_int(entries_value), fl_value_get_int(errors_value),
+                      fl_value_get_int(connections_value));
+    respond_success();
+    return;
+  }
+
+  fl_method_call_respond_not_implemented(method_call, nullptr);
+}
+
+static void capture_sync_tray(MyApplication* self) {
+  const bool capturing = self->capture != nullptr;
+  const bool closing = self->closing_capture != nullptr;
+  const bool replaying = self->replay != nullptr;
+  const bool can_replay = !replaying && self->last_capture_path != nullptr;
+
+  const struct {
+    const gchar* id;
+    bool enabled;
+  } states[] = {
+      {kTrayActionCaptureStart, !capturing && !closing},
+      {kTrayActionCaptureStop, capturing},
+      {kTrayActionCaptureReplay, can_replay},
+      {kTrayActionCaptureReplayFast, can_replay},
+      {kTrayActionCaptureReplayMax, can_replay},
+      {kTrayActionCaptureReplayStop, replaying},
+  };
+  for (const auto& state : states) {
+    GtkWidget* item = tray_lookup_item(self, state.id);
+    if (item != nullptr) {
+      gtk_widget_set_sensitive(item, state.enabled);
     }
+  }
+}
+
+// Tells Dart whether raw stream frames should be forwarded for capture.
+static void capture_notify_dart(MyApplication* self) {
+  if (self->capture_channel == nullptr || !self->capture_ready) {
+    return;
+  }
+
+  g_autoptr(FlValue) args = fl_value_new_bool(self->capture != nullptr);
+  fl_method_channel_invoke_method(self->capture_channel, "setCapturing", args,
+                                  nullptr, nullptr, nullptr);
+}
+
+static void capture_start(MyApplication* self) {
+  if (self->capture != nullptr || self->closing_capture != nullptr) {
+    return;
+  }
+
+  g_autofree gchar* path = stream_capture_new_default_path();
+  g_autoptr(GError) error = nullptr;
+  self->capture = stream_capture_new(path, &error);
+  if (self->capture == nullptr) {
+    g_warning("Failed to start stream capture: %s", error->message);
+    return;
+  }
 
-    gtk_menu_item_set_label(GTK_MENU_ITEM(item), label);
+  g_message("Capturing stream to %s", path);
+  capture_notify_dart(self);
+  capture_sync_tray(self);
+}
+
+// Closes the stopped capture once no more frames can arrive for it.
+static void capture_finish(MyApplication* self) {
+  if (self->closing_capture == nullptr) {
+    return;
+  }
+
+  g_autoptr(StreamCapture) capture = self->closing_capture;
+  self->closing_capture = nullptr;
+
+  g_autoptr(GError) error = nullptr;
+  if (stream_capture_close(capture, &error)) {
+    g_message("Captured %" G_GUINT64_FORMAT " frames to %s",
+              stream_capture_get_frame_count(capture),
+              stream_capture_get_path(capture));
+  } else {
+    g_warning("Stream capture %s is incomplete: %s",
+              stream_capture_get_path(capture), error->message);
+  }
+
+  g_free(self->last_capture_path);
+  self->last_capture_path = g_strdup(stream_capture_get_path(capture));
+  capture_sync_tray(self);
+}
+
+static void capture_stop_response_cb(GObject* object,
+                                     GAsyncResult* result,
+                                     gpointer user_data) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(FlMethodResponse) response = fl_method_channel_invoke_method_finish(
+      FL_METHOD_CHANNEL(object), result, &error);
+  if (response == nullptr) {
+    g_warning("Capture stop handshake failed: %s", error->message);
+  }
+
+  GApplication* application = g_application_get_default();
+  if (application == nullptr) {
+    return;
+  }
+  MyApplication* self = MY_APPLICATION(application);
+  if (self->closing_capture != nullptr &&
+      self->closing_capture_generation == GPOINTER_TO_UINT(user_data)) {
+    capture_finish(self);
+  }
+}
+
+// Stops forwarding and closes the file once Dart replies to
+// setCapturing(false); Dart flushes its pending batch before replying, so
+// the tail of a burst still lands in the capture.
+static void capture_stop(MyApplication* self) {
+  if (self->capture == nullptr) {
+    return;
+  }
+
+  self->closing_capture = self->capture;
+  self->closing_capture_generation++;
+  self->capture = nullptr;
+  capture_sync_tray(self);
+
+  if (self->capture_channel == nullptr || !self->capture_ready) {
+    capture_finish(self);
+    return;
+  }
+
+  g_autoptr(FlValue) args = fl_value_new_bool(FALSE);
+  fl_method_channel_invoke_method(self->capture_channel, "setCapturing", args,
+                                  nullptr, capture_stop_response_cb,
+                                  GUINT_TO_POINTER(self->closing_capture_generation));
+}
+
+static void replay_frames_response_cb(GObject* object,
+                                      GAsyncResult* result,
+                                      gpointer user_data) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(FlMethodResponse) response = fl_method_channel_invoke_method_finish(
+      FL_METHOD_CHANNEL(object), result, &error);
+  if (response == nullptr) {
+    g_warning("Replay batch delivery failed: %s", error->message);
+  }
+
+  // Only acknowledge batches of the replay that is still running.
+  GApplication* application = g_application_get_default();
+  if (application == nullptr) {
+    return;
+  }
+  MyApplication* self = MY_APPLICATION(application);
+  if (self->replay != nullptr && self->replay_generation == GPOINTER_TO_UINT(user_data)) {
+    stream_replay_batch_done(self->replay);
+  }
+}
+
+static void replay_batch_cb(const StreamCaptureFrame* frames,
+                            guint n_frames,
+                            gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+
+  g_autoptr(FlValue) args = fl_value_new_list();
+  for (guint i = 0; i < n_frames; i++) {
+    fl_value_append_take(args,
+                         fl_value_new_uint8_list(frames[i].data, frames[i].length));
+  }
+
+  // The next batch is paced off the Dart reply, so replay never outruns ingest.
+  fl_method_channel_invoke_method(self->capture_channel, "replayFrames", args,
+                                  nullptr, replay_frames_response_cb,
+                                  GUINT_TO_POINTER(self->replay_generation));
+}
+
+static void replay_done_cb(const GError* error, gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+
+  if (error != nullptr) {
+    g_warning("Replay stopped early: %s", error->message);
+  } else {
+    g_message("Replay finished");
+  }
+
+  g_clear_pointer(&self->replay, stream_replay_free);
+  capture_sync_tray(self);
+}
+
+static void replay_start(MyApplication* self, const gchar* path, gdouble speed) {
+  if (self->capture_channel == nullptr || path == nullptr) {
+    return;
+  }
+
+  g_clear_pointer(&self->replay, stream_replay_free);
+  self->replay_generation++;
+
+  g_autoptr(GError) error = nullptr;
+  self->replay = stream_replay_new(path, speed, replay_batch_cb, replay_done_cb,
+                                   self, &error);
+  if (self->replay == nullptr) {
+    g_warning("Failed to replay %s: %s", path, error->message);
+  } else if (speed > 0) {
+    g_message("Replaying %s at %gx", path, speed);
+  } else {
+    g_message("Replaying %s at max speed", path);
+  }
+
+  capture_sync_tray(self);
+}
+
+static void replay_stop(MyApplication* self) {
+  g_clear_pointer(&self->replay, stream_replay_free);
+  capture_sync_tray(self);
+}
+
+static void tray_capture_activate_cb(GtkMenuItem* /*menu_item*/, gpointer user_data) {
+  TrayActionData* data = static_cast<TrayActionData*>(user_data);
+  MyApplication* self = data->app;
+
+  if (g_strcmp0(data->id, kTrayActionCaptureStart) == 0) {
+    capture_start(self);
+  } else if (g_strcmp0(data->id, kTrayActionCaptureStop) == 0) {
+    capture_stop(self);
+  } else if (g_strcmp0(data->id, kTrayActionCaptureReplay) == 0) {
+    replay_start(self, self->last_capture_path, 1.0);
+  } else if (g_strcmp0(data->id, kTrayActionCaptureReplayFast) == 0) {
+    replay_start(self, self->last_capture_path, kReplayFastSpeed);
+  } else if (g_strcmp0(data->id, kTrayActionCaptureReplayMax) == 0) {
+    replay_start(self, self->last_capture_path, 0);
+  } else if (g_strcmp0(data->id, kTrayActionCaptureReplayStop) == 0) {
+    replay_stop(self);
+  }
+}
+
+static void capture_method_call_handler(FlMethodChannel* /*channel*/,
+                                        FlMethodCall* method_call,
+                                        gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  auto respond_success = [&]() {
+    g_autoptr(FlMethodResponse) response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
+    fl_method_call_respond(method_call, response, nullptr);
+  };
+
+  auto respond_error = [&](const gchar* code, const gchar* message) {
+    g_autoptr(FlMethodResponse) response = FL_METHOD_RESPONSE(
+        fl_method_error_response_new(code, message, fl_value_new_null()));
+    fl_method_call_respond(method_call, response, nullptr);
+  };
+
+  if (g_strcmp0(method, "ready") == 0) {
+    self->capture_ready = TRUE;
+    capture_notify_dart(self);
     respond_success();
+
+    if (self->startup_replay_path != nullptr) {
+      g_autofree gchar* path = self->startup_replay_path;
+      self->startup_replay_path = nullptr;
+      replay_start(self, path, self->startup_replay_speed);
+    }
     return;
   }
 
-  if (g_strcmp0(method, "setEnabled") == 0) {
+  if (g_strcmp0(method, "frames") == 0) {
     if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
       respond_error("bad_args", "Expected map arguments");
       return;
     }
-    FlValue* id_value = fl_value_lookup_string(args, "id");
-    FlValue* enabled_value = fl_value_lookup_string(args, "enabled");
-    if (id_value == nullptr || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING ||
-        enabled_value == nullptr || fl_value_get_type(enabled_value) != FL_VALUE_TYPE_BOOL) {
-      respond_error("bad_args", "Expected {id: string, enabled: bool}");
+    FlValue* timestamps_value = fl_value_lookup_string(args, "timestamps");
+    FlValue* frames_value = fl_value_lookup_string(args, "frames");
+    if (timestamps_value == nullptr ||
+        fl_value_get_type(timestamps_value) != FL_VALUE_TYPE_INT64_LIST ||
+        frames_value == nullptr || fl_value_get_type(frames_value) != FL_VALUE_TYPE_LIST ||
+        fl_value_get_length(timestamps_value) != fl_value_get_length(frames_value)) {
+      respond_error("bad_args", "Expected {timestamps: Int64List, frames: List<String>}");
       return;
     }
 
-    const gchar* id = fl_value_get_string(id_value);
-    const bool enabled = fl_value_get_bool(enabled_value);
-    GtkWidget* item = tray_lookup_item(self, id);
-    if (item == nullptr) {
-      g_warning("Tray setEnabled ignored; unknown id: %s", id);
-      respond_success();
-      return;
+    // After a stop, Dart's final batch still goes to the closing capture.
+    StreamCapture* capture =
+        self->capture != nullptr ? self->capture : self->closing_capture;
+    if (capture != nullptr) {
+      const int64_t* timestamps = fl_value_get_int64_list(timestamps_value);
+      const size_t length = fl_value_get_length(frames_value);
+      for (size_t i = 0; i < length; i++) {
+        FlValue* frame = fl_value_get_list_value(frames_value, i);
+        if (fl_value_get_type(frame) != FL_VALUE_TYPE_STRING) {
+          continue;
+        }
+        const gchar* data = fl_value_get_string(frame);
+        stream_capture_append(capture, timestamps[i],
+                              reinterpret_cast<const guint8*>(data), strlen(data));
+      }
     }
 
-    gtk_widget_set_sensitive(item, enabled);
     respond_success();
     return;
   }
 
-  if (g_strcmp0(method, "setChecked") == 0) {
+  fl_method_call_respond_not_implemented(method_call, nullptr);
+}
+
+static void capture_init(MyApplication* self, FlView* view) {
+  if (self->capture_channel != nullptr) {
+    return;
+  }
+
+  g_autoptr(FlStandardMethodCodec) capture_codec = fl_standard_method_codec_new();
+  self->capture_channel = fl_method_channel_new(
+      fl_engine_get_binary_messenger(fl_view_get_engine(view)), kCaptureChannelName,
+      FL_METHOD_CODEC(capture_codec));
+  fl_method_channel_set_method_call_handler(self->capture_channel,
+                                            capture_method_call_handler, self,
+                                            nullptr);
+}
+
+// ─── Loki backfill ───────────────────────────────────────────────────
+
+static void backfill_chunk_cb(const LokiBackfillEntry* entries,
+                              guint n_entries,
+                              gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+
+  g_autoptr(FlValue) lines = fl_value_new_list();
+  for (guint i = 0; i < n_entries; i++) {
+    fl_value_append_take(lines, fl_value_new_string(entries[i].line));
+  }
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "id", fl_value_new_int(self->backfill_id));
+  fl_value_set_string(args, "lines", lines);
+  fl_method_channel_invoke_method(self->loki_channel, "backfillEntries", args,
+                                  nullptr, nullptr, nullptr);
+}
+
+static void backfill_done_cb(guint64 n_entries, const GError* error, gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "id", fl_value_new_int(self->backfill_id));
+  fl_value_set_string_take(args, "count", fl_value_new_int(n_entries));
+  if (error != nullptr) {
+    fl_value_set_string_take(args, "error", fl_value_new_string(error->message));
+  }
+  fl_method_channel_invoke_method(self->loki_channel, "backfillDone", args, nullptr,
+                                  nullptr, nullptr);
+
+  g_clear_pointer(&self->backfill, loki_backfill_free);
+}
+
+static void loki_method_call_handler(FlMethodChannel* /*channel*/,
+                                     FlMethodCall* method_call,
+                                     gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  auto respond_success = [&]() {
+    g_autoptr(FlMethodResponse) response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
+    fl_method_call_respond(method_call, response, nullptr);
+  };
+
+  auto respond_error = [&](const gchar* code, const gchar* message) {
+    g_autoptr(FlMethodResponse) response = FL_METHOD_RESPONSE(
+        fl_method_error_response_new(code, message, fl_value_new_null()));
+    fl_method_call_respond(method_call, response, nullptr);
+  };
+
+  if (g_strcmp0(method, "backfill") == 0) {
     if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
       respond_error("bad_args", "Expected map arguments");
       return;
     }
     FlValue* id_value = fl_value_lookup_string(args, "id");
-    FlValue* checked_value = fl_value_lookup_string(args, "checked");
-    if (id_value == nullptr || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING ||
-        checked_value == nullptr || fl_value_get_type(checked_value) != FL_VALUE_TYPE_BOOL) {
-      respond_error("bad_args", "Expected {id: string, checked: bool}");
+    FlValue* url_value = fl_value_lookup_string(args, "lokiUrl");
+    FlValue* query_value = fl_value_lookup_string(args, "query");
+    FlValue* start_value = fl_value_lookup_string(args, "startMs");
+    FlValue* end_value = fl_value_lookup_string(args, "endMs");
+    if (id_value == nullptr || fl_value_get_type(id_value) != FL_VALUE_TYPE_INT ||
+        url_value == nullptr || fl_value_get_type(url_value) != FL_VALUE_TYPE_STRING ||
+        query_value == nullptr || fl_value_get_type(query_value) != FL_VALUE_TYPE_STRING ||
+        start_value == nullptr || fl_value_get_type(start_value) != FL_VALUE_TYPE_INT ||
+        end_value == nullptr || fl_value_get_type(end_value) != FL_VALUE_TYPE_INT) {
+      respond_error("bad_args",
+                    "Expected {id, lokiUrl, query, startMs, endMs}");
       return;
     }
 
-    const gchar* id = fl_value_get_string(id_value);
-    const bool checked = fl_value_get_bool(checked_value);
-    GtkWidget* item = tray_lookup_item(self, id);
-    if (item == nullptr) {
-      g_warning("Tray setChecked ignored; unknown id: %s", id);
-      respond_success();
-      return;
-    }
-    if (!GTK_IS_CHECK_MENU_ITEM(item)) {
-      g_warning("Tray setChecked ignored; id is not check item: %s", id);
-      respond_success();
+    // A new backfill supersedes the running one.
+    g_clear_pointer(&self->backfill, loki_backfill_free);
+
+    g_autofree gchar* cache_dir = loki_backfill_default_cache_dir();
+    const LokiBackfillOptions options = {
+        fl_value_get_string(url_value),
+        fl_value_get_string(query_value),
+        fl_value_get_int(start_value) * 1000000,
+        fl_value_get_int(end_value) * 1000000,
+        cache_dir,
+    };
+    g_autoptr(GError) error = nullptr;
+    self->backfill_id = fl_value_get_int(id_value);
+    self->backfill =
+        loki_backfill_new(&options, backfill_chunk_cb, backfill_done_cb, self, &error);
+    if (self->backfill == nullptr) {
+      respond_error("backfill_failed", error->message);
       return;
     }
+    respond_success();
+    return;
+  }
 
-    g_object_set_data(G_OBJECT(item), "logger-suppress", GINT_TO_POINTER(1));
-    gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(item), checked);
-    g_object_set_data(G_OBJECT(item), "logger-suppress", GINT_TO_POINTER(0));
-
+  if (g_strcmp0(method, "cancel") == 0) {
+    g_clear_pointer(&self->backfill, loki_backfill_free);
     respond_success();
     return;
   }
@@ -281,6 +867,19 @@ static void tray_method_call_handler(FlMethodChannel* /*channel*/,
   fl_method_call_respond_not_implemented(method_call, nullptr);
 }
 
+static void backfill_init(MyApplication* self, FlView* view) {
+  if (self->loki_channel != nullptr) {
+    return;
+  }
+
+  g_autoptr(FlStandardMethodCodec) loki_codec = fl_standard_method_codec_new();
+  self->loki_channel = fl_method_channel_new(
+      fl_engine_get_binary_messenger(fl_view_get_engine(view)), kLokiChannelName,
+      FL_METHOD_CODEC(loki_codec));
+  fl_method_channel_set_method_call_handler(self->loki_channel,
+                                            loki_method_call_handler, self, nullptr);
+}
+
 static void tray_init(MyApplication* self, FlView* view) {
   if (self->tray_indicator != nullptr) {
     return;
@@ -301,6 +900,12 @@ static void tray_init(MyApplication* self, FlView* view) {
   // Build tray menu.
   self->tray_menu = gtk_menu_new();
 
+  // 0) Live ingest stats (informational)
+  self->tray_stats_item = gtk_menu_item_new_with_label("Not connected");
+  gtk_widget_set_sensitive(self->tray_stats_item, FALSE);
+  gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), self->tray_stats_item);
+  gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), gtk_separator_menu_item_new());
+
   // 1) Show/hide logger
   self->tray_show_hide_item = gtk_menu_item_new_with_label("Show logger");
   g_signal_connect(self->tray_show_hide_item, "activate",
@@ -308,6 +913,13 @@ static void tray_init(MyApplication* self, FlView* view) {
   gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), self->tray_show_hide_item);
   tray_register_item(self, kTrayActionWindowToggle, self->tray_show_hide_item);
 
+  GtkWidget* new_window_item = gtk_menu_item_new_with_label("New window");
+  g_signal_connect_data(new_window_item, "activate", G_CALLBACK(tray_action_activate_cb),
+                        tray_action_data_new(self, kTrayActionWindowNew),
+                        tray_action_data_free, static_cast<GConnectFlags>(0));
+  gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), new_window_item);
+  tray_register_item(self, kTrayActionWindowNew, new_window_item);
+
   // separator
   gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), gtk_separator_menu_item_new());
 
@@ -394,6 +1006,38 @@ static void tray_init(MyApplication* self, FlView* view) {
     tray_register_item(self, kTrayActionExtensionsGrafana, grafana_item);
   }
 
+  // 4) Capture ▶
+  GtkWidget* capture_item = gtk_menu_item_new_with_label("Capture");
+  GtkWidget* capture_menu = gtk_menu_new();
+  gtk_menu_item_set_submenu(GTK_MENU_ITEM(capture_item), capture_menu);
+  gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), capture_item);
+
+  {
+    const struct {
+      const gchar* id;
+      const gchar* label;
+    } capture_actions[] = {
+        {kTrayActionCaptureStart, "Start capture"},
+        {kTrayActionCaptureStop, "Stop capture"},
+        {kTrayActionCaptureReplay, "Replay last capture (1×)"},
+        {kTrayActionCaptureReplayFast, "Replay last capture (10×)"},
+        {kTrayActionCaptureReplayMax, "Replay last capture (max speed)"},
+        {kTrayActionCaptureReplayStop, "Stop replay"},
+    };
+    for (const auto& action : capture_actions) {
+      if (g_strcmp0(action.id, kTrayActionCaptureReplay) == 0) {
+        gtk_menu_shell_append(GTK_MENU_SHELL(capture_menu),
+                              gtk_separator_menu_item_new());
+      }
+      GtkWidget* item = gtk_menu_item_new_with_label(action.label);
+      g_signal_connect_data(item, "activate", G_CALLBACK(tray_capture_activate_cb),
+                            tray_action_data_new(self, action.id),
+                            tray_action_data_free, static_cast<GConnectFlags>(0));
+      gtk_menu_shell_append(GTK_MENU_SHELL(capture_menu), item);
+      tray_register_item(self, action.id, item);
+    }
+  }
+
   // separator
   gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), gtk_separator_menu_item_new());
 
@@ -431,22 +1075,195 @@ static void tray_init(MyApplication* self, FlView* view) {
   app_indicator_set_menu(self->tray_indicator, GTK_MENU(self->tray_menu));
 
   tray_update_show_hide_label(self);
+  capture_sync_tray(self);
+}
+
+// Creates a top-level viewer window with the platform-appropriate title bar.
+static GtkWindow* viewer_window_new(MyApplication* self) {
+  GtkWindow* window =
+      GTK_WINDOW(gtk_application_window_new(GTK_APPLICATION(self)));
+
+  // Use a header bar when running in GNOME as this is the common style used
+  // by applications and is the setup most users will be using (e.g. Ubuntu
+  // desktop).
+  // If running on X and not using GNOME then just use a traditional title bar
+  // in case the window manager does more exotic layout, e.g. tiling.
+  // If running on Wayland assume the header bar will work (may need changing
+  // if future cases occur).
+  gboolean use_header_bar = TRUE;
+#ifdef GDK_WINDOWING_X11
+  GdkDisplay* display = gdk_display_get_default();
+  if (GDK_IS_X11_DISPLAY(display)) {
+    GdkScreen* screen = gtk_window_get_screen(window);
+    if (GDK_IS_X11_SCREEN(screen)) {
+      const gchar* wm_name = gdk_x11_screen_get_window_manager_name(screen);
+      if (g_strcmp0(wm_name, "GNOME Shell") != 0) {
+        use_header_bar = FALSE;
+      }
+    }
+  }
+#endif
+  if (use_header_bar) {
+    GtkHeaderBar* header_bar = GTK_HEADER_BAR(gtk_header_bar_new());
+    gtk_widget_show(GTK_WIDGET(header_bar));
+    gtk_header_bar_set_title(header_bar, "app");
+    gtk_header_bar_set_show_close_button(header_bar, TRUE);
+    gtk_window_set_titlebar(window, GTK_WIDGET(header_bar));
+  } else {
+    gtk_window_set_title(window, "app");
+  }
+
+  gtk_window_set_default_size(window, 1280, 720);
+
+  // Set application icon from bundle data directory.
+  {
+    g_autofree gchar* exe_path = g_file_read_link("/proc/self/exe", NULL);
+    if (exe_path != NULL) {
+      g_autofree gchar* exe_dir = g_path_get_dirname(exe_path);
+      g_autofree gchar* icon_path = g_build_filename(exe_dir, "data", "app_icon.png", NULL);
+      g_autoptr(GdkPixbuf) icon = gdk_pixbuf_new_from_file(icon_path, NULL);
+      if (icon != NULL) {
+        gtk_window_set_icon(window, icon);
+      }
+    }
+  }
+
+  return window;
+}
+
+// Puts a Flutter view into a window; the window is shown on the first frame.
+static void viewer_window_attach_view(MyApplication* self, GtkWindow* window, FlView* view) {
+  GdkRGBA background_color;
+  // Background defaults to black, override it here if necessary, e.g. #00000000
+  // for transparent.
+  gdk_rgba_parse(&background_color, "#000000");
+  fl_view_set_background_color(view, &background_color);
+  gtk_widget_show(GTK_WIDGET(view));
+  gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
+
+  // Show the window when Flutter renders.
+  // Requires the view to be realized so we can start rendering.
+  g_signal_connect_swapped(view, "first-frame", G_CALLBACK(first_frame_cb),
+                           self);
+  gtk_widget_realize(GTK_WIDGET(view));
+}
+
+static void viewer_window_destroy_cb(GtkWidget* window, gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+  if (self->viewer_windows != nullptr) {
+    g_ptr_array_remove(self->viewer_windows, window);
+  }
+}
+
+// Secondary views render through the main view's engine, so they cannot
+// outlive it.
+static void main_window_destroy_cb(GtkWidget* /*window*/, gpointer user_data) {
+  MyApplication* self = MY_APPLICATION(user_data);
+  while (self->viewer_windows != nullptr && self->viewer_windows->len > 0) {
+    gtk_widget_destroy(GTK_WIDGET(
+        g_ptr_array_index(self->viewer_windows, self->viewer_windows->len - 1)));
+  }
+  self->window = nullptr;
+  self->view = nullptr;
+}
+
+static void window_set_decorated(GtkWindow* window, gboolean decorated) {
+  GtkWidget* titlebar = gtk_window_get_titlebar(window);
+  if (titlebar != nullptr) {
+    gtk_widget_set_visible(titlebar, decorated);
+  } else {
+    gtk_window_set_decorated(window, decorated);
+  }
+}
+
+// Mini mode and always-on-top are shared by every view, so they apply to the
+// main window and all viewer windows alike.
+static void windows_set_decorated(MyApplication* self, gboolean decorated) {
+  if (self->window != nullptr) {
+    window_set_decorated(self->window, decorated);
+  }
+  for (guint i = 0; i < self->viewer_windows->len; i++) {
+    window_set_decorated(GTK_WINDOW(g_ptr_array_index(self->viewer_windows, i)), decorated);
+  }
+}
+
+static void windows_set_keep_above(MyApplication* self, gboolean keep_above) {
+  self->keep_above = keep_above;
+  if (self->window != nullptr) {
+    gtk_window_set_keep_above(self->window, keep_above);
+  }
+  for (guint i = 0; i < self->viewer_windows->len; i++) {
+    gtk_window_set_keep_above(GTK_WINDOW(g_ptr_array_index(self->viewer_windows, i)),
+                              keep_above);
+  }
+}
+
+// Opens another viewer window sharing the running engine, and with it the
+// Dart isolate, connections and log store. Returns the new view id, or -1.
+static gint64 viewer_window_open(MyApplication* self, gboolean decorated) {
+  if (self->view == nullptr) {
+    return -1;
+  }
+
+  GtkWindow* window = viewer_window_new(self);
+  window_set_decorated(window, decorated);
+  gtk_window_set_keep_above(window, self->keep_above);
+
+  FlView* view = fl_view_new_for_engine(fl_view_get_engine(self->view));
+  viewer_window_attach_view(self, window, view);
+
+  g_ptr_array_add(self->viewer_windows, window);
+  g_signal_connect(window, "destroy", G_CALLBACK(viewer_window_destroy_cb), self);
+
+  gtk_widget_grab_focus(GTK_WIDGET(view));
+  return fl_view_get_id(view);
 }
 
 // Method channel handler for com.logger/window.
 static void window_method_call_handler(FlMethodChannel* channel,
                                        FlMethodCall* method_call,
                                        gpointer user_data) {
-  GtkWindow* window = GTK_WINDOW(user_data);
+  MyApplication* self = MY_APPLICATION(user_data);
   const gchar* method = fl_method_call_get_name(method_call);
 
-  if (g_strcmp0(method, "setAlwaysOnTop") == 0) {
+  // All views share this channel, so per-window calls act on the window the
+  // user is interacting with; fetched at call time to ensure a valid pointer
+  // (T15 fix). Mini mode chrome is app-wide and applies to every window.
+  GtkWindow* window = gtk_application_get_active_window(GTK_APPLICATION(self));
+  if (window == NULL) {
+    window = self->window;
+  }
+  if (window == NULL && g_strcmp0(method, "openView") != 0) {
+    fl_method_call_respond_not_implemented(method_call, NULL);
+    return;
+  }
+
+  if (g_strcmp0(method, "openView") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    FlValue* decorated_value =
+        args != NULL && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+            ? fl_value_lookup_string(args, "decorated")
+            : NULL;
+    gboolean decorated = TRUE;
+    if (decorated_value != NULL && fl_value_get_type(decorated_value) == FL_VALUE_TYPE_BOOL) {
+      decorated = fl_value_get_bool(decorated_value);
+    }
+
+    const gint64 view_id = viewer_window_open(self, decorated);
+    if (view_id < 0) {
+      g_autoptr(FlMethodResponse) response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "unavailable", "Main view is not running", fl_value_new_null()));
+      fl_method_call_respond(method_call, response, NULL);
+      return;
+    }
+
+    g_autoptr(FlMethodResponse) response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_int(view_id)));
+    fl_method_call_respond(method_call, response, NULL);
+  } else if (g_strcmp0(method, "setAlwaysOnTop") == 0) {
     FlValue* args = fl_method_call_get_args(method_call);
     gboolean value = fl_value_get_bool(args);
-    // Fetch active window at call time to ensure valid pointer (T15 fix).
-    GtkWindow* active = GTK_WINDOW(gtk_application_get_active_window(
-        GTK_APPLICATION(g_application_get_default())));
-    gtk_window_set_keep_above(active != NULL ? active : window, value);
+    windows_set_keep_above(self, value);
 
     g_autoptr(FlMethodResponse) response =
         FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
@@ -482,12 +1299,7 @@ static void window_method_call_handler(FlMethodChannel* channel,
   } else if (g_strcmp0(method, "setDecorated") == 0) {
     FlValue* args = fl_method_call_get_args(method_call);
     gboolean value = fl_value_get_bool(args);
-    GtkWidget* titlebar = gtk_window_get_titlebar(window);
-    if (titlebar != NULL) {
-      gtk_widget_set_visible(titlebar, value);
-    } else {
-      gtk_window_set_decorated(window, value);
-    }
+    windows_set_decorated(self, value);
 
     g_autoptr(FlMethodResponse) response =
         FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_null()));
@@ -512,73 +1324,17 @@ static void window_method_call_handler(FlMethodChannel* channel,
 // Implements GApplication::activate.
 static void my_application_activate(GApplication* application) {
   MyApplication* self = MY_APPLICATION(application);
-  GtkWindow* window =
-      GTK_WINDOW(gtk_application_window_new(GTK_APPLICATION(application)));
+  GtkWindow* window = viewer_window_new(self);
   self->window = window;
-
-  // Use a header bar when running in GNOME as this is the common style used
-  // by applications and is the setup most users will be using (e.g. Ubuntu
-  // desktop).
-  // If running on X and not using GNOME then just use a traditional title bar
-  // in case the window manager does more exotic layout, e.g. tiling.
-  // If running on Wayland assume the header bar will work (may need changing
-  // if future cases occur).
-  gboolean use_header_bar = TRUE;
-#ifdef GDK_WINDOWING_X11
-  GdkDisplay* display = gdk_display_get_default();
-  if (GDK_IS_X11_DISPLAY(display)) {
-    GdkScreen* screen = gtk_window_get_screen(window);
-    if (GDK_IS_X11_SCREEN(screen)) {
-      const gchar* wm_name = gdk_x11_screen_get_window_manager_name(screen);
-      if (g_strcmp0(wm_name, "GNOME Shell") != 0) {
-        use_header_bar = FALSE;
-      }
-    }
-  }
-#endif
-  if (use_header_bar) {
-    GtkHeaderBar* header_bar = GTK_HEADER_BAR(gtk_header_bar_new());
-    gtk_widget_show(GTK_WIDGET(header_bar));
-    gtk_header_bar_set_title(header_bar, "app");
-    gtk_header_bar_set_show_close_button(header_bar, TRUE);
-    gtk_window_set_titlebar(window, GTK_WIDGET(header_bar));
-  } else {
-    gtk_window_set_title(window, "app");
-  }
-
-  gtk_window_set_default_size(window, 1280, 720);
-
-  // Set application icon from bundle data directory.
-  {
-    g_autofree gchar* exe_path = g_file_read_link("/proc/self/exe", NULL);
-    if (exe_path != NULL) {
-      g_autofree gchar* exe_dir = g_path_get_dirname(exe_path);
-      g_autofree gchar* icon_path = g_build_filename(exe_dir, "data", "app_icon.png", NULL);
-      g_autoptr(GdkPixbuf) icon = gdk_pixbuf_new_from_file(icon_path, NULL);
-      if (icon != NULL) {
-        gtk_window_set_icon(window, icon);
-      }
-    }
-  }
+  g_signal_connect(window, "destroy", G_CALLBACK(main_window_destroy_cb), self);
 
   g_autoptr(FlDartProject) project = fl_dart_project_new();
   fl_dart_project_set_dart_entrypoint_arguments(
       project, self->dart_entrypoint_arguments);
 
   FlView* view = fl_view_new(project);
-  GdkRGBA background_color;
-  // Background defaults to black, override it here if necessary, e.g. #00000000
-  // for transparent.
-  gdk_rgba_parse(&background_color, "#000000");
-  fl_view_set_background_color(view, &background_color);
-  gtk_widget_show(GTK_WIDGET(view));
-  gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
-
-  // Show the window when Flutter renders.
-  // Requires the view to be realized so we can start rendering.
-  g_signal_connect_swapped(view, "first-frame", G_CALLBACK(first_frame_cb),
-                           self);
-  gtk_widget_realize(GTK_WIDGET(view));
+  self->view = view;
+  viewer_window_attach_view(self, window, view);
 
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
 
@@ -588,11 +1344,17 @@ static void my_application_activate(GApplication* application) {
       fl_engine_get_binary_messenger(fl_view_get_engine(view)),
       "com.logger/window", FL_METHOD_CODEC(codec));
   fl_method_channel_set_method_call_handler(
-      window_channel, window_method_call_handler, window, NULL);
+      window_channel, window_method_call_handler, self, NULL);
 
     // Register tray method channel + tray icon/menu.
     tray_init(self, view);
 
+  // Register capture method channel for stream capture and replay.
+  capture_init(self, view);
+
+  // Register Loki method channel for parallel history backfill.
+  backfill_init(self, view);
+
   // Register URI method channel for logger:// deep-link forwarding.
   g_autoptr(FlStandardMethodCodec) uri_codec = fl_standard_method_codec_new();
   FlMethodChannel* uri_channel = fl_method_channel_new(
@@ -615,13 +1377,54 @@ static void my_application_activate(GApplication* application) {
   gtk_widget_grab_focus(GTK_WIDGET(view));
 }
 
+// Parses a --replay-speed value: a positive multiplier, or "max" (0) to
+// replay without pacing.
+static gboolean parse_replay_speed(const gchar* text, gdouble* speed) {
+  if (g_strcmp0(text, "max") == 0) {
+    *speed = 0;
+    return TRUE;
+  }
+
+  gchar* end = nullptr;
+  const gdouble value = g_ascii_strtod(text, &end);
+  if (end == text || *end != '\0' || !std::isfinite(value) || value <= 0) {
+    return FALSE;
+  }
+  *speed = value;
+  return TRUE;
+}
+
 // Implements GApplication::local_command_line.
 static gboolean my_application_local_command_line(GApplication* application,
                                                   gchar*** arguments,
                                                   int* exit_status) {
   MyApplication* self = MY_APPLICATION(application);
-  // Strip out the first argument as it is the binary name.
-  self->dart_entrypoint_arguments = g_strdupv(*arguments + 1);
+  // Strip out the first argument as it is the binary name, and the replay
+  // options which are handled natively.
+  GPtrArray* dart_arguments = g_ptr_array_new_with_free_func(g_free);
+  for (gchar** arg = *arguments + 1; *arg != nullptr; arg++) {
+    if (g_str_has_prefix(*arg, kReplayArgument)) {
+      const gchar* path = *arg + strlen(kReplayArgument);
+      g_free(self->startup_replay_path);
+      self->startup_replay_path = g_strdup(path);
+      g_free(self->last_capture_path);
+      self->last_capture_path = g_strdup(path);
+    } else if (g_str_has_prefix(*arg, kReplaySpeedArgument)) {
+      const gchar* speed = *arg + strlen(kReplaySpeedArgument);
+      if (!parse_replay_speed(speed, &self->startup_replay_speed)) {
+        g_printerr("Invalid --replay-speed \"%s\": expected a positive number or \"max\"\n",
+                   speed);
+        g_ptr_array_unref(dart_arguments);
+        *exit_status = 1;
+        return TRUE;
+      }
+    } else {
+      g_ptr_array_add(dart_arguments, g_strdup(*arg));
+    }
+  }
+  g_ptr_array_add(dart_arguments, nullptr);
+  self->dart_entrypoint_arguments =
+      reinterpret_cast<gchar**>(g_ptr_array_free(dart_arguments, FALSE));
 
   g_autoptr(GError) error = nullptr;
   if (!g_application_register(application, nullptr, &error)) {
@@ -649,12 +1452,30 @@ static void my_application_startup(GApplication* application) {
 static void my_application_shutdown(GApplication* application) {
   MyApplication* self = MY_APPLICATION(application);
 
+  // No reply will arrive during shutdown; close with what has been written.
+  capture_stop(self);
+  capture_finish(self);
+  g_clear_pointer(&self->replay, stream_replay_free);
+  g_clear_object(&self->capture_channel);
+
+  g_clear_pointer(&self->backfill, loki_backfill_free);
+  g_clear_object(&self->loki_channel);
+
+  if (self->tray_stats_source_id != 0) {
+    g_source_remove(self->tray_stats_source_id);
+    self->tray_stats_source_id = 0;
+  }
+  self->tray_stats_item = nullptr;
+  g_clear_pointer(&self->tray_stats_text, g_free);
+  g_clear_pointer(&self->tray_stats_label, g_free);
+
   g_clear_object(&self->tray_channel);
   g_clear_object(&self->tray_indicator);
   g_clear_pointer(&self->tray_items_by_id, g_hash_table_unref);
   self->tray_menu = nullptr;
   self->tray_show_hide_item = nullptr;
   self->window = nullptr;
+  self->view = nullptr;
 
   // Perform any actions required at application shutdown.
 
@@ -665,6 +1486,9 @@ static void my_application_shutdown(GApplication* application) {
 static void my_application_dispose(GObject* object) {
   MyApplication* self = MY_APPLICATION(object);
   g_clear_pointer(&self->dart_entrypoint_arguments, g_strfreev);
+  g_clear_pointer(&self->last_capture_path, g_free);
+  g_clear_pointer(&self->startup_replay_path, g_free);
+  g_clear_pointer(&self->viewer_windows, g_ptr_array_unref);
   G_OBJECT_CLASS(my_application_parent_class)->dispose(object);
 }
 
@@ -677,7 +1501,10 @@ static void my_application_class_init(MyApplicationClass* klass) {
   G_OBJECT_CLASS(klass)->dispose = my_application_dispose;
 }
 
-static void my_application_init(MyApplication* self) {}
+static void my_application_init(MyApplication* self) {
+  self->startup_replay_speed = 1.0;
+  self->viewer_windows = g_ptr_array_new();
+}
 
 MyApplication* my_application_new() {
   // Set the program name to the application ID, which helps various systems
@@ -0,0 +1,663 @@
+#include "stream_capture.h"
+
+#include <string.h>
+
+namespace {
+
+constexpr guint8 kCaptureMagic[8] = {'L', 'G', 'R', 'C', 'A', 'P', 0, 1};
+constexpr gsize kCaptureHeaderSize = 16;
+constexpr gsize kBlockHeaderSize = 12;
+
+// Blocks are flushed once they reach this size or age, whichever is first.
+constexpr gsize kCaptureBlockSize = 64 * 1024;
+constexpr gint64 kCaptureBlockMaxAgeUs = G_USEC_PER_SEC;
+constexpr gint kCaptureCompressionLevel = 3;
+
+// Upper bound for a single block when reading, to reject corrupt headers.
+constexpr guint32 kMaxBlockSize = 64 * 1024 * 1024;
+
+constexpr guint kReplayMaxQueuedBlocks = 8;
+constexpr guint kReplayMaxBatchFrames = 512;
+
+void put_u32(guint8* out, guint32 value) {
+  for (gsize i = 0; i < 4; i++) {
+    out[i] = static_cast<guint8>(value >> (8 * i));
+  }
+}
+
+void put_i64(guint8* out, gint64 value) {
+  const guint64 bits = static_cast<guint64>(value);
+  for (gsize i = 0; i < 8; i++) {
+    out[i] = static_cast<guint8>(bits >> (8 * i));
+  }
+}
+
+guint32 get_u32(const guint8* in) {
+  guint32 value = 0;
+  for (gsize i = 0; i < 4; i++) {
+    value |= static_cast<guint32>(in[i]) << (8 * i);
+  }
+  return value;
+}
+
+void append_varint(GByteArray* out, guint64 value) {
+  guint8 buffer[10];
+  guint length = 0;
+  do {
+    guint8 byte = value & 0x7f;
+    value >>= 7;
+    if (value != 0) {
+      byte |= 0x80;
+    }
+    buffer[length++] = byte;
+  } while (value != 0);
+  g_byte_array_append(out, buffer, length);
+}
+
+gboolean read_varint(const guint8* data, gsize length, gsize* pos, guint64* value) {
+  guint64 result = 0;
+  for (guint shift = 0; *pos < length && shift < 64; shift += 7) {
+    const guint8 byte = data[(*pos)++];
+    result |= static_cast<guint64>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+// Runs @converter over the whole of @input in one go.
+GBytes* zlib_convert(GConverter* converter,
+                     const guint8* input,
+                     gsize input_length,
+                     gsize output_hint,
+                     GError** error) {
+  g_converter_reset(converter);
+
+  GByteArray* output = g_byte_array_sized_new(MAX(output_hint, 64));
+  g_byte_array_set_size(output, MAX(output_hint, 64));
+  gsize input_pos = 0;
+  gsize output_pos = 0;
+
+  for (;;) {
+    gsize bytes_read = 0;
+    gsize bytes_written = 0;
+    g_autoptr(GError) local_error = nullptr;
+    const GConverterResult result = g_converter_convert(
+        converter, input + input_pos, input_length - input_pos,
+        output->data + output_pos, output->len - output_pos,
+        G_CONVERTER_INPUT_AT_END, &bytes_read, &bytes_written, &local_error);
+    if (result == G_CONVERTER_ERROR) {
+      if (g_error_matches(local_error, G_IO_ERROR, G_IO_ERROR_NO_SPACE)) {
+        g_byte_array_set_size(output, output->len * 2);
+        continue;
+      }
+      g_propagate_error(error, g_steal_pointer(&local_error));
+      g_byte_array_unref(output);
+      return nullptr;
+    }
+
+    input_pos += bytes_read;
+    output_pos += bytes_written;
+    if (result == G_CONVERTER_FINISHED) {
+      break;
+    }
+    if (output_pos == output->len) {
+      g_byte_array_set_size(output, output->len * 2);
+    }
+  }
+
+  g_byte_array_set_size(output, output_pos);
+  return g_byte_array_free_to_bytes(output);
+}
+
+// A block handed from the capturing thread to the writer thread.
+struct CaptureBlock {
+  // Uncompressed records; nullptr marks the end of the capture.
+  GByteArray* raw;
+  guint32 frame_count;
+};
+
+void capture_block_free(CaptureBlock* block) {
+  g_clear_pointer(&block->raw, g_byte_array_unref);
+  g_free(block);
+}
+
+// A decoded block handed from the reader thread to the main context.
+struct ReplayBlock {
+  // Decompressed records; nullptr marks the end of the replay.
+  GBytes* raw;
+  // StreamCaptureFrame entries pointing into raw.
+  GArray* frames;
+  GError* error;
+};
+
+void replay_block_free(ReplayBlock* block) {
+  if (block == nullptr) {
+    return;
+  }
+  g_clear_pointer(&block->frames, g_array_unref);
+  g_clear_pointer(&block->raw, g_bytes_unref);
+  g_clear_error(&block->error);
+  g_free(block);
+}
+
+}  // namespace
+
+struct _StreamCapture {
+  gchar* path;
+  GOutputStream* stream;
+
+  GThread* writer;
+  GAsyncQueue* blocks;
+  // Written by the writer thread only; read after it was joined.
+  GError* error;
+
+  GByteArray* pending;
+  guint32 pending_frames;
+  gint64 pending_started_us;
+  // Flushes the pending block once it is due, even if no further frame comes.
+  guint flush_source_id;
+
+  gboolean has_timestamp;
+  gint64 last_timestamp_us;
+  guint64 frame_count;
+  gboolean closed;
+};
+
+struct _StreamReplay {
+  GInputStream* stream;
+  gdouble speed;
+  StreamReplayBatchFunc batch_func;
+  StreamReplayDoneFunc done_func;
+  gpointer user_data;
+
+  GThread* reader;
+  GAsyncQueue* blocks;
+  GMutex lock;
+  GCond cond;
+  guint queued_blocks;
+  gboolean cancelled;
+
+  GMainContext* context;
+  GSource* source;
+  gint64 start_us;
+  ReplayBlock* current;
+  guint next_frame;
+  gboolean awaiting_ack;
+  gboolean finished;
+};
+
+// ─── Capture ─────────────────────────────────────────────────────────
+
+static gboolean capture_write_block(StreamCapture* self,
+                                    GConverter* compressor,
+                                    CaptureBlock* block,
+                                    GError** error) {
+  g_autoptr(GBytes) compressed = zlib_convert(
+      compressor, block->raw->data, block->raw->len, block->raw->len / 2, error);
+  if (compressed == nullptr) {
+    return FALSE;
+  }
+
+  gsize compressed_length = 0;
+  const guint8* compressed_data =
+      static_cast<const guint8*>(g_bytes_get_data(compressed, &compressed_length));
+
+  guint8 header[kBlockHeaderSize];
+  put_u32(header, block->raw->len);
+  put_u32(header + 4, static_cast<guint32>(compressed_length));
+  put_u32(header + 8, block->frame_count);
+
+  return g_output_stream_write_all(self->stream, header, sizeof(header), nullptr,
+                                   nullptr, error) &&
+         g_output_stream_write_all(self->stream, compressed_data,
+                                   compressed_length, nullptr, nullptr, error);
+}
+
+static gpointer capture_writer_thread(gpointer user_data) {
+  StreamCapture* self = static_cast<StreamCapture*>(user_data);
+  g_autoptr(GZlibCompressor) compressor = g_zlib_compressor_new(
+      G_ZLIB_COMPRESSOR_FORMAT_RAW, kCaptureCompressionLevel);
+
+  for (;;) {
+    CaptureBlock* block = static_cast<CaptureBlock*>(g_async_queue_pop(self->blocks));
+    if (block->raw == nullptr) {
+      capture_block_free(block);
+      break;
+    }
+
+    // After the first failure keep draining the queue, but stop writing.
+    if (self->error == nullptr) {
+      capture_write_block(self, G_CONVERTER(compressor), block, &self->error);
+    }
+    capture_block_free(block);
+  }
+
+  return nullptr;
+}
+
+static void capture_flush_pending(StreamCapture* self) {
+  if (self->flush_source_id != 0) {
+    g_source_remove(self->flush_source_id);
+    self->flush_source_id = 0;
+  }
+  if (self->pending == nullptr) {
+    return;
+  }
+
+  CaptureBlock* block = g_new0(CaptureBlock, 1);
+  block->raw = g_steal_pointer(&self->pending);
+  block->frame_count = self->pending_frames;
+  self->pending_frames = 0;
+  g_async_queue_push(self->blocks, block);
+}
+
+static gboolean capture_flush_timeout_cb(gpointer user_data) {
+  StreamCapture* self = static_cast<StreamCapture*>(user_data);
+  self->flush_source_id = 0;
+  capture_flush_pending(self);
+  return G_SOURCE_REMOVE;
+}
+
+StreamCapture* stream_capture_new(const gchar* path, GError** error) {
+  g_autoptr(GFile) file = g_file_new_for_path(path);
+  g_autoptr(GFile) parent = g_file_get_parent(file);
+  if (parent != nullptr) {
+    g_autoptr(GError) mkdir_error = nullptr;
+    if (!g_file_make_directory_with_parents(parent, nullptr, &mkdir_error) &&
+        !g_error_matches(mkdir_error, G_IO_ERROR, G_IO_ERROR_EXISTS)) {
+      g_propagate_error(error, g_steal_pointer(&mkdir_error));
+      return nullptr;
+    }
+  }
+
+  g_autoptr(GFileOutputStream) stream = g_file_replace(
+      file, nullptr, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, nullptr, error);
+  if (stream == nullptr) {
+    return nullptr;
+  }
+
+  guint8 header[kCaptureHeaderSize];
+  memcpy(header, kCaptureMagic, sizeof(kCaptureMagic));
+  put_i64(header + sizeof(kCaptureMagic), g_get_real_time());
+  if (!g_output_stream_write_all(G_OUTPUT_STREAM(stream), header, sizeof(header),
+                                 nullptr, nullptr, error)) {
+    return nullptr;
+  }
+
+  StreamCapture* self = g_new0(StreamCapture, 1);
+  self->path = g_strdup(path);
+  self->stream = G_OUTPUT_STREAM(g_steal_pointer(&stream));
+  self->blocks = g_async_queue_new();
+  self->writer = g_thread_new("logger-capture", capture_writer_thread, self);
+  return self;
+}
+
+void stream_capture_append(StreamCapture* self,
+                           gint64 timestamp_us,
+                           const guint8* data,
+                           gsize length) {
+  g_return_if_fail(self != nullptr);
+  if (self->closed) {
+    return;
+  }
+
+  gint64 delta_us = 0;
+  if (!self->has_timestamp) {
+    self->has_timestamp = TRUE;
+    self->last_timestamp_us = timestamp_us;
+  } else if (timestamp_us > self->last_timestamp_us) {
+    delta_us = timestamp_us - self->last_timestamp_us;
+    self->last_timestamp_us = timestamp_us;
+  }
+
+  if (self->pending == nullptr) {
+    self->pending = g_byte_array_sized_new(kCaptureBlockSize + length + 20);
+    self->pending_started_us = g_get_monotonic_time();
+    self->flush_source_id = g_timeout_add(kCaptureBlockMaxAgeUs / 1000,
+                                          capture_flush_timeout_cb, self);
+  }
+
+  append_varint(self->pending, static_cast<guint64>(delta_us));
+  append_varint(self->pending, length);
+  g_byte_array_append(self->pending, data, static_cast<guint>(length));
+  self->pending_frames++;
+  self->frame_count++;
+
+  if (self->pending->len >= kCaptureBlockSize ||
+      g_get_monotonic_time() - self->pending_started_us >= kCaptureBlockMaxAgeUs) {
+    capture_flush_pending(self);
+  }
+}
+
+const gchar* stream_capture_get_path(StreamCapture* self) {
+  g_return_val_if_fail(self != nullptr, nullptr);
+  return self->path;
+}
+
+guint64 stream_capture_get_frame_count(StreamCapture* self) {
+  g_return_val_if_fail(self != nullptr, 0);
+  return self->frame_count;
+}
+
+gboolean stream_capture_close(StreamCapture* self, GError** error) {
+  g_return_val_if_fail(self != nullptr, FALSE);
+
+  if (!self->closed) {
+    self->closed = TRUE;
+    capture_flush_pending(self);
+    g_async_queue_push(self->blocks, g_new0(CaptureBlock, 1));
+    g_thread_join(self->writer);
+    self->writer = nullptr;
+
+    g_autoptr(GError) close_error = nullptr;
+    if (!g_output_stream_close(self->stream, nullptr, &close_error) &&
+        self->error == nullptr) {
+      self->error = g_steal_pointer(&close_error);
+    }
+  }
+
+  if (self->error != nullptr) {
+    g_propagate_error(error, g_error_copy(self->error));
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void stream_capture_free(StreamCapture* self) {
+  if (self == nullptr) {
+    return;
+  }
+
+  stream_capture_close(self, nullptr);
+  g_clear_object(&self->stream);
+  g_clear_pointer(&self->blocks, g_async_queue_unref);
+  g_clear_error(&self->error);
+  g_clear_pointer(&self->path, g_free);
+  g_free(self);
+}
+
+gchar* stream_capture_new_default_path() {
+  g_autoptr(GDateTime) now = g_date_time_new_now_local();
+  g_autofree gchar* name = g_date_time_format(now, "stream-%Y%m%d-%H%M%S.lgcap");
+  return g_build_filename(g_get_user_data_dir(), "logger", "captures", name,
+                          nullptr);
+}
+
+// ─── Replay ──────────────────────────────────────────────────────────
+
+// Reads and decodes the next block. Returns %FALSE without setting @error at
+// the end of the file.
+static gboolean replay_read_block(GInputStream* stream,
+                                  GConverter* decompressor,
+                                  gint64* offset_us,
+                                  ReplayBlock* block,
+                                  GError** error) {
+  guint8 header[kBlockHeaderSize];
+  gsize bytes_read = 0;
+  if (!g_input_stream_read_all(stream, header, sizeof(header), &bytes_read,
+                               nullptr, error)) {
+    return FALSE;
+  }
+  if (bytes_read == 0) {
+    return FALSE;
+  }
+
+  const guint32 raw_size = get_u32(header);
+  const guint32 compressed_size = get_u32(header + 4);
+  const guint32 frame_count = get_u32(header + 8);
+  if (bytes_read != sizeof(header) || raw_size == 0 || raw_size > kMaxBlockSize ||
+      compressed_size > kMaxBlockSize) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Corrupt capture block header");
+    return FALSE;
+  }
+
+  g_autofree guint8* compressed = static_cast<guint8*>(g_malloc(compressed_size));
+  if (!g_input_stream_read_all(stream, compressed, compressed_size, &bytes_read,
+                               nullptr, error)) {
+    return FALSE;
+  }
+  if (bytes_read != compressed_size) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+                "Truncated capture block");
+    return FALSE;
+  }
+
+  g_autoptr(GBytes) raw =
+      zlib_convert(decompressor, compressed, compressed_size, raw_size, error);
+  if (raw == nullptr) {
+    return FALSE;
+  }
+
+  gsize raw_length = 0;
+  const guint8* data = static_cast<const guint8*>(g_bytes_get_data(raw, &raw_length));
+  GArray* frames = g_array_sized_new(FALSE, FALSE, sizeof(StreamCaptureFrame),
+                                     MIN(frame_count, raw_size / 2));
+  gsize pos = 0;
+  while (pos < raw_length) {
+    guint64 delta_us = 0;
+    guint64 length = 0;
+    if (!read_varint(data, raw_length, &pos, &delta_us) ||
+        !read_varint(data, raw_length, &pos, &length) || length > raw_length - pos) {
+      g_array_unref(frames);
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "Corrupt capture record");
+      return FALSE;
+    }
+
+    *offset_us += static_cast<gint64>(delta_us);
+    StreamCaptureFrame frame = {*offset_us, data + pos, static_cast<gsize>(length)};
+    g_array_append_val(frames, frame);
+    pos += length;
+  }
+
+  block->raw = g_steal_pointer(&raw);
+  block->frames = frames;
+  return TRUE;
+}
+
+static gpointer replay_reader_thread(gpointer user_data) {
+  StreamReplay* self = static_cast<StreamReplay*>(user_data);
+  g_autoptr(GZlibDecompressor) decompressor =
+      g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW);
+  gint64 offset_us = 0;
+
+  for (;;) {
+    g_mutex_lock(&self->lock);
+    while (self->queued_blocks >= kReplayMaxQueuedBlocks && !self->cancelled) {
+      g_cond_wait(&self->cond, &self->lock);
+    }
+    const gboolean cancelled = self->cancelled;
+    if (!cancelled) {
+      self->queued_blocks++;
+    }
+    g_mutex_unlock(&self->lock);
+    if (cancelled) {
+      break;
+    }
+
+    // A block without raw data (end of file or read error) ends the replay.
+    ReplayBlock* block = g_new0(ReplayBlock, 1);
+    const gboolean has_block = replay_read_block(
+        self->stream, G_CONVERTER(decompressor), &offset_us, block, &block->error);
+    g_async_queue_push(self->blocks, block);
+    if (!has_block) {
+      break;
+    }
+  }
+
+  return nullptr;
+}
+
+static void replay_pump(StreamReplay* self);
+
+static gboolean replay_tick_cb(gpointer user_data) {
+  StreamReplay* self = static_cast<StreamReplay*>(user_data);
+  g_clear_pointer(&self->source, g_source_unref);
+  replay_pump(self);
+  return G_SOURCE_REMOVE;
+}
+
+static void replay_schedule(StreamReplay* self, guint delay_ms) {
+  if (self->source != nullptr || self->finished) {
+    return;
+  }
+
+  self->source = delay_ms == 0 ? g_idle_source_new() : g_timeout_source_new(delay_ms);
+  g_source_set_callback(self->source, replay_tick_cb, self, nullptr);
+  g_source_attach(self->source, self->context);
+}
+
+static gint64 replay_due_time(StreamReplay* self, const StreamCaptureFrame* frame) {
+  return self->start_us + static_cast<gint64>(frame->offset_us / self->speed);
+}
+
+static void replay_pump(StreamReplay* self) {
+  if (self->awaiting_ack || self->finished) {
+    return;
+  }
+
+  if (self->current != nullptr && self->current->raw != nullptr &&
+      self->next_frame >= self->current->frames->len) {
+    g_clear_pointer(&self->current, replay_block_free);
+  }
+
+  if (self->current == nullptr) {
+    ReplayBlock* block = static_cast<ReplayBlock*>(g_async_queue_try_pop(self->blocks));
+    if (block == nullptr) {
+      // The reader thread has not decoded the next block yet.
+      replay_schedule(self, 1);
+      return;
+    }
+
+    g_mutex_lock(&self->lock);
+    self->queued_blocks--;
+    g_cond_signal(&self->cond);
+    g_mutex_unlock(&self->lock);
+
+    self->current = block;
+    self->next_frame = 0;
+  }
+
+  if (self->current->raw == nullptr) {
+    self->finished = TRUE;
+    if (self->done_func != nullptr) {
+      // May free the replay; nothing may touch self afterwards.
+      self->done_func(self->current->error, self->user_data);
+    }
+    return;
+  }
+
+  // Batches never span blocks so frame data stays valid for the callback.
+  GArray* frames = self->current->frames;
+  const gint64 now = g_get_monotonic_time();
+  const guint first = self->next_frame;
+  guint end = first;
+  while (end < frames->len && end - first < kReplayMaxBatchFrames) {
+    if (self->speed > 0 &&
+        replay_due_time(self, &g_array_index(frames, StreamCaptureFrame, end)) > now) {
+      break;
+    }
+    end++;
+  }
+
+  if (end == first) {
+    const gint64 due =
+        replay_due_time(self, &g_array_index(frames, StreamCaptureFrame, first));
+    replay_schedule(self, static_cast<guint>(MAX((due - now + 999) / 1000, 1)));
+    return;
+  }
+
+  self->next_frame = end;
+  self->awaiting_ack = TRUE;
+  self->batch_func(&g_array_index(frames, StreamCaptureFrame, first), end - first,
+                   self->user_data);
+}
+
+StreamReplay* stream_replay_new(const gchar* path,
+                                gdouble speed,
+                                StreamReplayBatchFunc batch_func,
+                                StreamReplayDoneFunc done_func,
+                                gpointer user_data,
+                                GError** error) {
+  g_return_val_if_fail(batch_func != nullptr, nullptr);
+
+  g_autoptr(GFile) file = g_file_new_for_path(path);
+  g_autoptr(GFileInputStream) stream = g_file_read(file, nullptr, error);
+  if (stream == nullptr) {
+    return nullptr;
+  }
+
+  guint8 header[kCaptureHeaderSize];
+  gsize bytes_read = 0;
+  if (!g_input_stream_read_all(G_INPUT_STREAM(stream), header, sizeof(header),
+                               &bytes_read, nullptr, error)) {
+    return nullptr;
+  }
+  if (bytes_read != sizeof(header) ||
+      memcmp(header, kCaptureMagic, sizeof(kCaptureMagic)) != 0) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Not a logger capture file: %s", path);
+    return nullptr;
+  }
+
+  StreamReplay* self = g_new0(StreamReplay, 1);
+  self->stream = G_INPUT_STREAM(g_steal_pointer(&stream));
+  self->speed = speed;
+  self->batch_func = batch_func;
+  self->done_func = done_func;
+  self->user_data = user_data;
+  self->blocks = g_async_queue_new();
+  g_mutex_init(&self->lock);
+  g_cond_init(&self->cond);
+  self->context = g_main_context_ref_thread_default();
+  self->start_us = g_get_monotonic_time();
+  self->reader = g_thread_new("logger-replay", replay_reader_thread, self);
+
+  replay_schedule(self, 0);
+  return self;
+}
+
+void stream_replay_batch_done(StreamReplay* self) {
+  g_return_if_fail(self != nullptr);
+  if (!self->awaiting_ack) {
+    return;
+  }
+
+  self->awaiting_ack = FALSE;
+  replay_schedule(self, 0);
+}
+
+void stream_replay_free(StreamReplay* self) {
+  if (self == nullptr) {
+    return;
+  }
+
+  g_mutex_lock(&self->lock);
+  self->cancelled = TRUE;
+  g_cond_signal(&self->cond);
+  g_mutex_unlock(&self->lock);
+  g_thread_join(self->reader);
+
+  if (self->source != nullptr) {
+    g_source_destroy(self->source);
+    g_clear_pointer(&self->source, g_source_unref);
+  }
+
+  ReplayBlock* block = nullptr;
+  while ((block = static_cast<ReplayBlock*>(g_async_queue_try_pop(self->blocks))) !=
+         nullptr) {
+    replay_block_free(block);
+  }
+  g_clear_pointer(&self->current, replay_block_free);
+
+  g_clear_pointer(&self->blocks, g_async_queue_unref);
+  g_clear_object(&self->stream);
+  g_clear_pointer(&self->context, g_main_context_unref);
+  g_mutex_clear(&self->lock);
+  g_cond_clear(&self->cond);
+  g_free(self);
+}
@@ -0,0 +1,164 @@
+#ifndef FLUTTER_STREAM_CAPTURE_H_
+#define FLUTTER_STREAM_CAPTURE_H_
+
+#include <gio/gio.h>
+
+// Capture file layout (all integers little-endian):
+//
+//   header: "LGRCAP\0\1" magic (8 bytes), capture start wall-clock µs (i64)
+//   block:  raw size (u32), compressed size (u32), frame count (u32),
+//           raw-deflate payload
+//
+// A decompressed block payload is a sequence of records, each a LEB128
+// receive-time delta in µs (relative to the previous record), a LEB128 frame
+// length and the raw frame bytes.
+
+/**
+ * StreamCaptureFrame:
+ * @offset_us: receive time relative to the first captured frame.
+ * @data: raw frame bytes; only valid for the duration of the callback.
+ * @length: number of bytes in @data.
+ */
+typedef struct {
+  gint64 offset_us;
+  const guint8* data;
+  gsize length;
+} StreamCaptureFrame;
+
+typedef struct _StreamCapture StreamCapture;
+
+/**
+ * stream_capture_new:
+ * @path: file to create; an existing file is replaced.
+ * @error: (allow-none): return location for a #GError.
+ *
+ * Starts a capture. Frames are batched into blocks on the calling thread and
+ * compressed and written by a dedicated writer thread. A block that stops
+ * filling up is flushed from the default main context after a second.
+ *
+ * Returns: a new #StreamCapture, or %NULL on error.
+ */
+StreamCapture* stream_capture_new(const gchar* path, GError** error);
+
+/**
+ * stream_capture_append:
+ * @capture: a #StreamCapture.
+ * @timestamp_us: monotonic receive timestamp of the frame.
+ * @data: raw frame bytes.
+ * @length: number of bytes in @data.
+ *
+ * Records one frame. Timestamps only need to be monotonic relative to each
+ * other; earlier timestamps than the previous frame are clamped.
+ */
+void stream_capture_append(StreamCapture* capture,
+                           gint64 timestamp_us,
+                           const guint8* data,
+                           gsize length);
+
+/**
+ * stream_capture_get_path:
+ * @capture: a #StreamCapture.
+ *
+ * Returns: the path of the capture file.
+ */
+const gchar* stream_capture_get_path(StreamCapture* capture);
+
+/**
+ * stream_capture_get_frame_count:
+ * @capture: a #StreamCapture.
+ *
+ * Returns: the number of frames appended so far.
+ */
+guint64 stream_capture_get_frame_count(StreamCapture* capture);
+
+/**
+ * stream_capture_close:
+ * @capture: a #StreamCapture.
+ * @error: (allow-none): return location for a #GError.
+ *
+ * Flushes the pending block and waits for the writer thread to finish.
+ *
+ * Returns: %TRUE if every block was written successfully.
+ */
+gboolean stream_capture_close(StreamCapture* capture, GError** error);
+
+/**
+ * stream_capture_free:
+ * @capture: a #StreamCapture.
+ *
+ * Closes @capture if needed and frees it.
+ */
+void stream_capture_free(StreamCapture* capture);
+
+/**
+ * stream_capture_new_default_path:
+ *
+ * Returns: a new timestamped capture path in the user data directory.
+ */
+gchar* stream_capture_new_default_path();
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(StreamCapture, stream_capture_free)
+
+typedef struct _StreamReplay StreamReplay;
+
+/**
+ * StreamReplayBatchFunc:
+ * @frames: frames that are due, in capture order.
+ * @n_frames: number of entries in @frames.
+ * @user_data: user data passed to stream_replay_new().
+ *
+ * Receives the next batch of frames. No further batch is delivered until
+ * stream_replay_batch_done() is called.
+ */
+typedef void (*StreamReplayBatchFunc)(const StreamCaptureFrame* frames,
+                                      guint n_frames,
+                                      gpointer user_data);
+
+/**
+ * StreamReplayDoneFunc:
+ * @error: (allow-none): the read error that ended the replay, if any.
+ * @user_data: user data passed to stream_replay_new().
+ */
+typedef void (*StreamReplayDoneFunc)(const GError* error, gpointer user_data);
+
+/**
+ * stream_replay_new:
+ * @path: capture file to replay.
+ * @speed: playback rate relative to the recorded timing; 0 or less replays as
+ *   fast as the receiver acknowledges batches.
+ * @batch_func: called on the main context with each batch of due frames.
+ * @done_func: called on the main context once all frames were delivered.
+ * @user_data: user data for the callbacks.
+ * @error: (allow-none): return location for a #GError.
+ *
+ * Starts replaying a capture. Blocks are read and decompressed on a reader
+ * thread; frames are paced on the thread-default main context.
+ *
+ * Returns: a new #StreamReplay, or %NULL if @path is not a capture file.
+ */
+StreamReplay* stream_replay_new(const gchar* path,
+                                gdouble speed,
+                                StreamReplayBatchFunc batch_func,
+                                StreamReplayDoneFunc done_func,
+                                gpointer user_data,
+                                GError** error);
+
+/**
+ * stream_replay_batch_done:
+ * @replay: a #StreamReplay.
+ *
+ * Acknowledges the last batch so the next one can be delivered.
+ */
+void stream_replay_batch_done(StreamReplay* replay);
+
+/**
+ * stream_replay_free:
+ * @replay: a #StreamReplay.
+ *
+ * Stops the replay without calling the done callback and frees it.
+ */
+void stream_replay_free(StreamReplay* replay);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(StreamReplay, stream_replay_free)
+
+#endif  // FLUTTER_STREAM_CAPTURE_H_
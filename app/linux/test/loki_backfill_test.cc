@@ -0,0 +1,527 @@
+// Tests for the native Loki backfill engine against an in-process fake
+// `query_range` endpoint.
+
+#include "loki_backfill.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+namespace {
+
+constexpr gint64 kNsPerMs = G_GINT64_CONSTANT(1000000);
+constexpr gint64 kNsPerMinute = 60 * 1000 * kNsPerMs;
+
+// 2021-01-01T00:00:00Z: shard aligned and long settled, so shards are
+// eligible for the cache.
+constexpr gint64 kBaseNs = G_GINT64_CONSTANT(1609459200000) * kNsPerMs;
+
+constexpr const gchar* kSelector = "{app=~\".+\"}";
+constexpr guint kStreams = 2;
+constexpr gsize kFakeChunkBytes = 4096;
+
+// ─── Fake Loki ───────────────────────────────────────────────────────
+
+struct FakeEntry {
+  gint64 timestamp_ns;
+  guint stream;
+  gchar* line;
+  // Structured metadata, like the server's per-entry session id.
+  gchar* session;
+};
+
+struct FakeLoki {
+  GSocketService* service;
+  gchar* url;
+  // Added in timestamp order; equal timestamps keep insertion order.
+  GArray* entries;
+  gboolean chunked;
+  guint status;
+  gint requests;
+  gint active;
+};
+
+void fake_entry_clear(gpointer data) {
+  FakeEntry* entry = static_cast<FakeEntry*>(data);
+  g_free(entry->line);
+  g_free(entry->session);
+}
+
+// Encodes @text as a JSON string the way a strict encoder might: every
+// non-ASCII character and control character as a `\u` escape.
+void json_append_string(GString* out, const gchar* text) {
+  g_string_append_c(out, '"');
+  for (const gchar* p = text; *p != '\0'; p = g_utf8_next_char(p)) {
+    gunichar c = g_utf8_get_char(p);
+    if (c == '"' || c == '\\') {
+      g_string_append_c(out, '\\');
+      g_string_append_c(out, static_cast<gchar>(c));
+    } else if (c == '/') {
+      g_string_append(out, "\\/");
+    } else if (c == '\n') {
+      g_string_append(out, "\\n");
+    } else if (c < 0x20 || (c >= 0x80 && c < 0x10000)) {
+      g_string_append_printf(out, "\\u%04x", c);
+    } else if (c >= 0x10000) {
+      c -= 0x10000;
+      g_string_append_printf(out, "\\u%04x\\u%04x", 0xD800 + (c >> 10),
+                             0xDC00 + (c & 0x3FF));
+    } else {
+      g_string_append_c(out, static_cast<gchar>(c));
+    }
+  }
+  g_string_append_c(out, '"');
+}
+
+// Accepts the selector alone or followed by a `| session="<id>"` label
+// filter; returns the unescaped session id, or %NULL for no filter.
+gchar* fake_loki_session_filter(const gchar* query) {
+  g_assert_true(g_str_has_prefix(query, kSelector));
+  const gchar* rest = query + strlen(kSelector);
+  if (*rest == '\0') {
+    return nullptr;
+  }
+
+  constexpr const gchar* kFilterPrefix = " | session=\"";
+  g_assert_true(g_str_has_prefix(rest, kFilterPrefix));
+  GString* session = g_string_new(nullptr);
+  const gchar* p = rest + strlen(kFilterPrefix);
+  for (; *p != '\0' && *p != '"'; p++) {
+    if (*p == '\\') {
+      p++;
+      g_assert_true(*p == '\\' || *p == '"');
+    }
+    g_string_append_c(session, *p);
+  }
+  g_assert_cmpstr(p, ==, "\"");
+  return g_string_free(session, FALSE);
+}
+
+// Builds a query_range response for @params. Like Loki, `end` is inclusive
+// and entries are returned oldest first, at most `limit` of them.
+GString* fake_loki_query_range(FakeLoki* fake, GHashTable* params) {
+  g_autofree gchar* session = fake_loki_session_filter(
+      static_cast<const gchar*>(g_hash_table_lookup(params, "query")));
+  g_assert_cmpstr(static_cast<const gchar*>(g_hash_table_lookup(params, "direction")),
+                  ==, "FORWARD");
+  const gint64 start_ns = g_ascii_strtoll(
+      static_cast<const gchar*>(g_hash_table_lookup(params, "start")), nullptr, 10);
+  const gint64 end_ns = g_ascii_strtoll(
+      static_cast<const gchar*>(g_hash_table_lookup(params, "end")), nullptr, 10);
+  const guint64 limit = g_ascii_strtoull(
+      static_cast<const gchar*>(g_hash_table_lookup(params, "limit")), nullptr, 10);
+
+  GString* values[kStreams];
+  for (guint s = 0; s < kStreams; s++) {
+    values[s] = g_string_new(nullptr);
+  }
+  guint64 count = 0;
+  for (guint i = 0; i < fake->entries->len && count < limit; i++) {
+    const FakeEntry* entry = &g_array_index(fake->entries, FakeEntry, i);
+    if (entry->timestamp_ns < start_ns || entry->timestamp_ns > end_ns ||
+        (session != nullptr && g_strcmp0(entry->session, session) != 0)) {
+      continue;
+    }
+    count++;
+
+    GString* out = values[entry->stream];
+    g_string_append_printf(out, "%s[\"%" G_GINT64_FORMAT "\",", out->len > 0 ? "," : "",
+                           entry->timestamp_ns);
+    json_append_string(out, entry->line);
+    // Structured metadata follows the line, as newer Loki returns it.
+    if (entry->session != nullptr) {
+      g_string_append(out, ",{\"session\":");
+      json_append_string(out, entry->session);
+      g_string_append_c(out, '}');
+    } else if (entry->stream == 1) {
+      g_string_append(out, ",{\"trace_id\":\"abc\",\"nested\":[1,{\"x\":null}]}");
+    }
+    g_string_append_c(out, ']');
+  }
+
+  GString* body = g_string_new("{\"status\":\"success\",\"data\":{\"resultType\":\"streams\","
+                               "\"result\":[");
+  gboolean first = TRUE;
+  for (guint s = 0; s < kStreams; s++) {
+    if (values[s]->len > 0) {
+      g_string_append_printf(body,
+                             "%s{\"stream\":{\"app\":\"test\",\"stream\":\"%u\"},"
+                             "\"values\":[%s]}",
+                             first ? "" : ",", s, values[s]->str);
+      first = FALSE;
+    }
+    g_string_free(values[s], TRUE);
+  }
+  g_string_append(body, "],\"stats\":{\"summary\":{\"totalEntriesReturned\":");
+  g_string_append_printf(body, "%" G_GUINT64_FORMAT "}}}}", count);
+  return body;
+}
+
+void fake_loki_respond(FakeLoki* fake, GOutputStream* output, const GString* body) {
+  g_autoptr(GString) response = g_string_new(nullptr);
+  if (fake->status != 200) {
+    g_string_append_printf(response,
+                           "HTTP/1.1 %u Bad Gateway\r\n"
+                           "Content-Length: %" G_GSIZE_FORMAT "\r\n\r\n%s",
+                           fake->status, strlen("upstream down"), "upstream down");
+  } else if (fake->chunked) {
+    g_string_append(response,
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: application/json\r\n"
+                    "Transfer-Encoding: chunked\r\n\r\n");
+    for (gsize offset = 0; offset < body->len; offset += kFakeChunkBytes) {
+      const gsize size = MIN(kFakeChunkBytes, body->len - offset);
+      g_string_append_printf(response, "%" G_GSIZE_MODIFIER "x\r\n", size);
+      g_string_append_len(response, body->str + offset, size);
+      g_string_append(response, "\r\n");
+    }
+    g_string_append(response, "0\r\n\r\n");
+  } else {
+    g_string_append_printf(response,
+                           "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: application/json\r\n"
+                           "Content-Length: %" G_GSIZE_FORMAT "\r\n\r\n",
+                           body->len);
+    g_string_append_len(response, body->str, body->len);
+  }
+  g_output_stream_write_all(output, response->str, response->len, nullptr, nullptr,
+                            nullptr);
+}
+
+void fake_loki_serve(FakeLoki* fake, GSocketConnection* connection) {
+  g_autoptr(GDataInputStream) input = g_data_input_stream_new(
+      g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+  g_data_input_stream_set_newline_type(input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+
+  g_autofree gchar* request_line =
+      g_data_input_stream_read_line(input, nullptr, nullptr, nullptr);
+  if (request_line == nullptr) {
+    return;
+  }
+  for (;;) {
+    g_autofree gchar* header = g_data_input_stream_read_line(input, nullptr, nullptr, nullptr);
+    if (header == nullptr || header[0] == '\0') {
+      break;
+    }
+  }
+  g_atomic_int_inc(&fake->requests);
+
+  // "GET /loki/api/v1/query_range?<params> HTTP/1.1"
+  g_auto(GStrv) parts = g_strsplit(request_line, " ", 3);
+  g_assert_cmpstr(parts[0], ==, "GET");
+  g_assert_nonnull(parts[1]);
+  g_assert_true(g_str_has_prefix(parts[1], "/loki/api/v1/query_range?"));
+  g_autoptr(GHashTable) params = g_uri_parse_params(
+      strchr(parts[1], '?') + 1, -1, "&", G_URI_PARAMS_NONE, nullptr);
+  g_assert_nonnull(params);
+
+  g_autoptr(GString) body = fake_loki_query_range(fake, params);
+  fake_loki_respond(fake, g_io_stream_get_output_stream(G_IO_STREAM(connection)), body);
+}
+
+gboolean fake_loki_run_cb(GThreadedSocketService* /*service*/,
+                          GSocketConnection* connection,
+                          GObject* /*source_object*/,
+                          gpointer user_data) {
+  FakeLoki* fake = static_cast<FakeLoki*>(user_data);
+  g_atomic_int_inc(&fake->active);
+  fake_loki_serve(fake, connection);
+  g_atomic_int_add(&fake->active, -1);
+  return TRUE;
+}
+
+FakeLoki* fake_loki_new() {
+  FakeLoki* fake = g_new0(FakeLoki, 1);
+  fake->entries = g_array_new(FALSE, FALSE, sizeof(FakeEntry));
+  g_array_set_clear_func(fake->entries, fake_entry_clear);
+  fake->status = 200;
+
+  // More threads than the engine runs requests in parallel.
+  fake->service = g_threaded_socket_service_new(16);
+  g_autoptr(GInetAddress) loopback = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+  g_autoptr(GSocketAddress) address = g_inet_socket_address_new(loopback, 0);
+  g_autoptr(GSocketAddress) bound = nullptr;
+  g_autoptr(GError) error = nullptr;
+  g_socket_listener_add_address(G_SOCKET_LISTENER(fake->service), address,
+                                G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP, nullptr,
+                                &bound, &error);
+  g_assert_no_error(error);
+
+  g_signal_connect(fake->service, "run", G_CALLBACK(fake_loki_run_cb), fake);
+  g_socket_service_start(fake->service);
+  fake->url = g_strdup_printf(
+      "http://127.0.0.1:%u",
+      g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(bound)));
+  return fake;
+}
+
+void fake_loki_add(FakeLoki* fake,
+                   gint64 timestamp_ns,
+                   guint stream,
+                   const gchar* line,
+                   const gchar* session = nullptr) {
+  FakeEntry entry = {timestamp_ns, stream, g_strdup(line), g_strdup(session)};
+  g_array_append_val(fake->entries, entry);
+}
+
+void fake_loki_free(FakeLoki* fake) {
+  g_socket_service_stop(fake->service);
+  g_socket_listener_close(G_SOCKET_LISTENER(fake->service));
+  // A handler may still be returning after its client has hung up.
+  while (g_atomic_int_get(&fake->active) > 0) {
+    g_usleep(1000);
+  }
+  g_object_unref(fake->service);
+  g_array_unref(fake->entries);
+  g_free(fake->url);
+  g_free(fake);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FakeLoki, fake_loki_free)
+
+// ─── Backfill runs ───────────────────────────────────────────────────
+
+struct BackfillRun {
+  GPtrArray* lines;
+  GArray* timestamps;
+  guint n_chunks;
+  guint64 n_entries;
+  GError* error;
+  GMainLoop* loop;
+};
+
+void backfill_run_chunk_cb(const LokiBackfillEntry* entries,
+                           guint n_entries,
+                           gpointer user_data) {
+  BackfillRun* run = static_cast<BackfillRun*>(user_data);
+  run->n_chunks++;
+  // Chunks arrive newest first; prepending keeps timestamp order.
+  for (guint i = 0; i < n_entries; i++) {
+    g_ptr_array_insert(run->lines, i, g_strdup(entries[i].line));
+    g_array_insert_val(run->timestamps, i, entries[i].timestamp_ns);
+  }
+}
+
+void backfill_run_done_cb(guint64 n_entries, const GError* error, gpointer user_data) {
+  BackfillRun* run = static_cast<BackfillRun*>(user_data);
+  run->n_entries = n_entries;
+  if (error != nullptr) {
+    run->error = g_error_copy(error);
+  }
+  g_main_loop_quit(run->loop);
+}
+
+// Backfills `[start_ns, end_ns)` from @fake and waits for it to finish.
+void backfill_run(BackfillRun* run,
+                  FakeLoki* fake,
+                  gint64 start_ns,
+                  gint64 end_ns,
+                  const gchar* cache_dir,
+                  const gchar* query = kSelector) {
+  run->lines = g_ptr_array_new_with_free_func(g_free);
+  run->timestamps = g_array_new(FALSE, FALSE, sizeof(gint64));
+  run->loop = g_main_loop_new(nullptr, FALSE);
+
+  const LokiBackfillOptions options = {fake->url, query, start_ns, end_ns, cache_dir};
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(LokiBackfill) backfill = loki_backfill_new(
+      &options, backfill_run_chunk_cb, backfill_run_done_cb, run, &error);
+  g_assert_no_error(error);
+  g_main_loop_run(run->loop);
+}
+
+void backfill_run_clear(BackfillRun* run) {
+  g_clear_pointer(&run->lines, g_ptr_array_unref);
+  g_clear_pointer(&run->timestamps, g_array_unref);
+  g_clear_pointer(&run->loop, g_main_loop_unref);
+  g_clear_error(&run->error);
+}
+
+void assert_lines(const BackfillRun* run, const gchar* const* expected, guint n_expected) {
+  g_assert_cmpuint(run->lines->len, ==, n_expected);
+  g_assert_cmpuint(run->n_entries, ==, n_expected);
+  for (guint i = 0; i < n_expected; i++) {
+    g_assert_cmpstr(static_cast<const gchar*>(g_ptr_array_index(run->lines, i)), ==,
+                    expected[i]);
+  }
+}
+
+void remove_cache_dir(const gchar* path) {
+  g_autoptr(GDir) dir = g_dir_open(path, 0, nullptr);
+  const gchar* name = nullptr;
+  while (dir != nullptr && (name = g_dir_read_name(dir)) != nullptr) {
+    g_autofree gchar* file = g_build_filename(path, name, nullptr);
+    g_unlink(file);
+  }
+  g_rmdir(path);
+}
+
+// ─── Tests ───────────────────────────────────────────────────────────
+
+// A shard larger than one page is fetched in pages that restart at the last
+// timestamp; entries sharing that timestamp must appear exactly once.
+void test_page_boundary_dedupe() {
+  constexpr guint kEntries = 6000;
+  g_autoptr(FakeLoki) fake = fake_loki_new();
+  fake->chunked = TRUE;
+  for (guint i = 0; i < kEntries; i++) {
+    // Ten entries straddle the first 5000-entry page.
+    const guint tick = i >= 4995 && i < 5005 ? 4995 : i;
+    g_autofree gchar* line = g_strdup_printf("{\"id\":\"e%u\"}", i);
+    fake_loki_add(fake, kBaseNs + tick * kNsPerMs, i % kStreams, line);
+  }
+
+  BackfillRun run = {};
+  backfill_run(&run, fake, kBaseNs, kBaseNs + 15 * kNsPerMinute, nullptr);
+
+  g_assert_no_error(run.error);
+  g_assert_cmpint(g_atomic_int_get(&fake->requests), ==, 2);
+  g_assert_cmpuint(run.n_entries, ==, kEntries);
+  g_assert_cmpuint(run.lines->len, ==, kEntries);
+  g_assert_cmpuint(run.n_chunks, ==, 3);
+
+  g_autoptr(GHashTable) seen = g_hash_table_new(g_str_hash, g_str_equal);
+  for (guint i = 0; i < run.lines->len; i++) {
+    g_assert_true(g_hash_table_add(seen, g_ptr_array_index(run.lines, i)));
+    if (i > 0) {
+      g_assert_cmpint(g_array_index(run.timestamps, gint64, i - 1), <=,
+                      g_array_index(run.timestamps, gint64, i));
+    }
+  }
+  backfill_run_clear(&run);
+}
+
+// Entries outside the range, and the one Loki returns for both shards at
+// their shared boundary, are clamped; escaped lines decode intact.
+void test_shard_clamping_and_json() {
+  const gchar* escaped = "quote \" backslash \\ slash / newline \n tab \t ctl \x01 é €  😀";
+  g_autoptr(FakeLoki) fake = fake_loki_new();
+  fake_loki_add(fake, kBaseNs + 5 * kNsPerMinute, 0, "before the range");
+  fake_loki_add(fake, kBaseNs + 10 * kNsPerMinute, 0, escaped);
+  fake_loki_add(fake, kBaseNs + 15 * kNsPerMinute, 1, "on the shard boundary");
+  fake_loki_add(fake, kBaseNs + 19 * kNsPerMinute, 1, "last in range");
+  fake_loki_add(fake, kBaseNs + 20 * kNsPerMinute, 0, "at the range end");
+  fake_loki_add(fake, kBaseNs + 25 * kNsPerMinute, 0, "after the range");
+
+  BackfillRun run = {};
+  backfill_run(&run, fake, kBaseNs + 10 * kNsPerMinute, kBaseNs + 20 * kNsPerMinute,
+               nullptr);
+
+  g_assert_no_error(run.error);
+  g_assert_cmpint(g_atomic_int_get(&fake->requests), ==, 2);
+  const gchar* expected[] = {escaped, "on the shard boundary", "last in range"};
+  assert_lines(&run, expected, G_N_ELEMENTS(expected));
+  g_assert_cmpint(g_array_index(run.timestamps, gint64, 1), ==,
+                  kBaseNs + 15 * kNsPerMinute);
+  backfill_run_clear(&run);
+}
+
+// Settled shards are written to the cache and served from it next time.
+void test_cache_round_trip() {
+  g_autoptr(GError) error = nullptr;
+  g_autofree gchar* cache_dir = g_dir_make_tmp("loki-backfill-test-XXXXXX", &error);
+  g_assert_no_error(error);
+
+  g_autoptr(FakeLoki) fake = fake_loki_new();
+  for (guint i = 0; i < 30; i++) {
+    g_autofree gchar* line = g_strdup_printf("minute %u ✓", i);
+    fake_loki_add(fake, kBaseNs + i * kNsPerMinute + 1, i % kStreams, line);
+  }
+
+  BackfillRun fetched = {};
+  backfill_run(&fetched, fake, kBaseNs, kBaseNs + 30 * kNsPerMinute, cache_dir);
+  g_assert_no_error(fetched.error);
+  g_assert_cmpint(g_atomic_int_get(&fake->requests), ==, 2);
+  g_assert_cmpuint(fetched.lines->len, ==, 30);
+
+  BackfillRun cached = {};
+  backfill_run(&cached, fake, kBaseNs, kBaseNs + 30 * kNsPerMinute, cache_dir);
+  g_assert_no_error(cached.error);
+  g_assert_cmpint(g_atomic_int_get(&fake->requests), ==, 2);
+  assert_lines(&cached, reinterpret_cast<const gchar* const*>(fetched.lines->pdata),
+               fetched.lines->len);
+  for (guint i = 0; i < cached.timestamps->len; i++) {
+    g_assert_cmpint(g_array_index(cached.timestamps, gint64, i), ==,
+                    g_array_index(fetched.timestamps, gint64, i));
+  }
+
+  backfill_run_clear(&fetched);
+  backfill_run_clear(&cached);
+  remove_cache_dir(cache_dir);
+}
+
+// Session backfills filter on structured metadata; the query must reach
+// Loki intact, escapes included.
+void test_session_metadata_filter() {
+  const gchar* session = "a\"b\\c";
+  g_autoptr(FakeLoki) fake = fake_loki_new();
+  fake_loki_add(fake, kBaseNs + 1 * kNsPerMinute, 0, "first", session);
+  fake_loki_add(fake, kBaseNs + 2 * kNsPerMinute, 1, "other session", "other");
+  fake_loki_add(fake, kBaseNs + 3 * kNsPerMinute, 0, "no session");
+  fake_loki_add(fake, kBaseNs + 4 * kNsPerMinute, 1, "second", session);
+
+  BackfillRun run = {};
+  backfill_run(&run, fake, kBaseNs, kBaseNs + 15 * kNsPerMinute, nullptr,
+               "{app=~\".+\"} | session=\"a\\\"b\\\\c\"");
+
+  g_assert_no_error(run.error);
+  const gchar* expected[] = {"first", "second"};
+  assert_lines(&run, expected, G_N_ELEMENTS(expected));
+  backfill_run_clear(&run);
+}
+
+void test_http_error() {
+  g_autoptr(FakeLoki) fake = fake_loki_new();
+  fake->status = 502;
+  fake_loki_add(fake, kBaseNs + kNsPerMinute, 0, "unreachable");
+
+  BackfillRun run = {};
+  backfill_run(&run, fake, kBaseNs, kBaseNs + 15 * kNsPerMinute, nullptr);
+
+  g_assert_error(run.error, G_IO_ERROR, G_IO_ERROR_FAILED);
+  g_assert_nonnull(strstr(run.error->message, "HTTP 502"));
+  g_assert_cmpuint(run.n_entries, ==, 0);
+  backfill_run_clear(&run);
+}
+
+void url_chunk_cb(const LokiBackfillEntry* /*entries*/,
+                  guint /*n_entries*/,
+                  gpointer /*user_data*/) {
+  g_assert_not_reached();
+}
+
+// IPv6 literals parse; malformed URLs are rejected up front. Accepted
+// backfills are freed before they could connect, so no callback may run.
+void test_url_parsing() {
+  const gchar* valid[] = {"http://[::1]:3100", "https://[::1]/loki/", "http://localhost"};
+  for (const gchar* url : valid) {
+    const LokiBackfillOptions options = {url, kSelector, kBaseNs, kBaseNs + 1, nullptr};
+    g_autoptr(GError) error = nullptr;
+    LokiBackfill* backfill = loki_backfill_new(&options, url_chunk_cb, nullptr, nullptr, &error);
+    g_assert_no_error(error);
+    g_assert_nonnull(backfill);
+    loki_backfill_free(backfill);
+  }
+
+  const gchar* invalid[] = {"ftp://[::1]:3100", "http://[::1]:99999", "http://[::1", "http://"};
+  for (const gchar* url : invalid) {
+    const LokiBackfillOptions options = {url, kSelector, kBaseNs, kBaseNs + 1, nullptr};
+    g_autoptr(GError) error = nullptr;
+    g_assert_null(loki_backfill_new(&options, url_chunk_cb, nullptr, nullptr, &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  g_test_init(&argc, &argv, nullptr);
+
+  g_test_add_func("/loki-backfill/page-boundary-dedupe", test_page_boundary_dedupe);
+  g_test_add_func("/loki-backfill/shard-clamping-and-json", test_shard_clamping_and_json);
+  g_test_add_func("/loki-backfill/cache-round-trip", test_cache_round_trip);
+  g_test_add_func("/loki-backfill/session-metadata-filter", test_session_metadata_filter);
+  g_test_add_func("/loki-backfill/http-error", test_http_error);
+  g_test_add_func("/loki-backfill/url-parsing", test_url_parsing);
+
+  return g_test_run();
+}
@@ -3,6 +3,7 @@ import 'dart:io';
 
 import 'package:app/models/log_entry.dart';
 import 'package:app/models/server_broadcast.dart';
+import 'package:app/models/stream_flow.dart';
 import 'package:app/models/viewer_message.dart';
 import 'package:flutter_test/flutter_test.dart';
 
@@ -131,6 +132,16 @@ void main() {
       final msg = ServerBroadcast.fromJson(json);
       expect(msg, isA<SubscribeAckMessage>());
     });
+
+    test('broadcast_flow_state.json', () {
+      final json = loadFixture('broadcast_flow_state.json');
+      final msg = ServerBroadcast.fromJson(json);
+      expect(msg, isA<FlowStateMessage>());
+      final flow = msg as FlowStateMessage;
+      expect(flow.mode, equals(FlowMode.sample));
+      expect(flow.coalesced, equals(12));
+      expect(flow.withheld, equals({'debug': 340, 'info': 95}));
+    });
   });
 
   group('ViewerCommand fixture conformance', () {
@@ -167,5 +178,11 @@ void main() {
       expect(output['session_id'], equals(json['session_id']));
       expect(output['limit'], equals(json['limit']));
     });
+
+    test('command_flow_control.json round-trip', () {
+      final json = loadFixture('command_flow_control.json');
+      final msg = ViewerFlowControlMessage(consumed: json['consumed'] as int);
+      expect(msg.toJson(), equals(json));
+    });
   });
 }
@@ -1,5 +1,6 @@
 import 'package:app/models/log_entry.dart';
 import 'package:app/models/server_broadcast.dart';
+import 'package:app/models/stream_flow.dart';
 import 'package:flutter_test/flutter_test.dart';
 
 void main() {
@@ -236,6 +237,21 @@ void main() {
       expect(msg, isA<SubscribeAckMessage>());
     });
 
+    test('type flow_state parses mode and counts', () {
+      final msg = ServerBroadcast.fromJson({
+        'type': 'flow_state',
+        'mode': 'summary',
+        'coalesced': 3,
+        'withheld': {'debug': 10, 'info': 2},
+      });
+
+      expect(msg, isA<FlowStateMessage>());
+      final flow = msg as FlowStateMessage;
+      expect(flow.mode, FlowMode.summary);
+      expect(flow.coalesced, 3);
+      expect(flow.withheld, {'debug': 10, 'info': 2});
+    });
+
     // ── Test 14: malformed JSON ──
 
     test('event with missing entry returns ErrorMessage', () {
@@ -0,0 +1,169 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:app/models/server_broadcast.dart';
+import 'package:app/services/capture_service.dart';
+import 'package:app/services/connection_manager.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+class _FakeCapturePlatform implements CapturePlatformApi {
+  int readyCalls = 0;
+  final List<({Int64List timestamps, List<String> frames})> batches = [];
+
+  /// When set, sendFrames completes only once this does.
+  Completer<void>? gate;
+
+  @override
+  Future<void> ready() async {
+    readyCalls++;
+  }
+
+  @override
+  Future<void> sendFrames({
+    required Int64List timestamps,
+    required List<String> frames,
+  }) async {
+    batches.add((timestamps: timestamps, frames: frames));
+    await gate?.future;
+  }
+}
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  group('CaptureService', () {
+    test('start signals ready to the platform', () async {
+      final platform = _FakeCapturePlatform();
+      final service = CaptureService(
+        connectionManager: ConnectionManager(),
+        platform: platform,
+      );
+
+      await service.start();
+
+      expect(platform.readyCalls, 1);
+      await service.dispose();
+    });
+
+    test('taps raw frames only while capturing', () async {
+      final mgr = ConnectionManager();
+      final service = CaptureService(
+        connectionManager: mgr,
+        platform: _FakeCapturePlatform(),
+      );
+      await service.start();
+
+      expect(mgr.rawFrameTap, isNull);
+
+      await service.handleMethodCall(const MethodCall('setCapturing', true));
+      expect(service.capturing, isTrue);
+      expect(mgr.rawFrameTap, isNotNull);
+
+      await service.handleMethodCall(const MethodCall('setCapturing', false));
+      expect(service.capturing, isFalse);
+      expect(mgr.rawFrameTap, isNull);
+
+      await service.dispose();
+    });
+
+    test('stopping capture flushes pending frames with timestamps', () async {
+      final mgr = ConnectionManager();
+      final platform = _FakeCapturePlatform();
+      final service = CaptureService(connectionManager: mgr, platform: platform);
+      await service.start();
+
+      await service.handleMethodCall(const MethodCall('setCapturing', true));
+      mgr.rawFrameTap!('{"type":"ack","ids":["a"]}');
+      mgr.rawFrameTap!('{"type":"ack","ids":["b"]}');
+      expect(platform.batches, isEmpty);
+
+      await service.handleMethodCall(const MethodCall('setCapturing', false));
+
+      expect(platform.batches, hasLength(1));
+      final batch = platform.batches.single;
+      expect(batch.frames, [
+        '{"type":"ack","ids":["a"]}',
+        '{"type":"ack","ids":["b"]}',
+      ]);
+      expect(batch.timestamps, hasLength(2));
+      expect(batch.timestamps[1], greaterThanOrEqualTo(batch.timestamps[0]));
+
+      await service.dispose();
+    });
+
+    test('stop completes only after the final batch is delivered', () async {
+      final mgr = ConnectionManager();
+      final platform = _FakeCapturePlatform();
+      final service = CaptureService(connectionManager: mgr, platform: platform);
+      await service.start();
+
+      await service.handleMethodCall(const MethodCall('setCapturing', true));
+      mgr.rawFrameTap!('{"type":"ack","ids":["tail"]}');
+
+      platform.gate = Completer<void>();
+      var stopped = false;
+      final stop = service
+          .handleMethodCall(const MethodCall('setCapturing', false))
+          .then((_) => stopped = true);
+      await Future<void>.delayed(Duration.zero);
+
+      expect(platform.batches, hasLength(1));
+      expect(stopped, isFalse);
+
+      platform.gate!.complete();
+      await stop;
+      expect(stopped, isTrue);
+
+      await service.dispose();
+    });
+
+    test('full batches are forwarded without waiting for the timer', () async {
+      final mgr = ConnectionManager();
+      final platform = _FakeCapturePlatform();
+      final service = CaptureService(connectionManager: mgr, platform: platform);
+      await service.start();
+
+      await service.handleMethodCall(const MethodCall('setCapturing', true));
+      for (var i = 0; i < CaptureService.maxBatchFrames; i++) {
+        mgr.rawFrameTap!('{"type":"ack","ids":["$i"]}');
+      }
+
+      expect(platform.batches, hasLength(1));
+      expect(
+        platform.batches.single.frames,
+        hasLength(CaptureService.maxBatchFrames),
+      );
+
+      await service.dispose();
+    });
+
+    test('replayed frames flow through ConnectionManager.messages', () async {
+      final mgr = ConnectionManager();
+      final service = CaptureService(
+        connectionManager: mgr,
+        platform: _FakeCapturePlatform(),
+      );
+      await service.start();
+
+      final received = <ServerBroadcast>[];
+      final sub = mgr.messages.listen(received.add);
+
+      await service.handleMethodCall(
+        MethodCall('replayFrames', [
+          Uint8List.fromList(utf8.encode('{"type":"ack","ids":["x"]}')),
+          Uint8List.fromList(utf8.encode('not json')),
+        ]),
+      );
+      await Future<void>.delayed(Duration.zero);
+
+      expect(received, hasLength(1));
+      expect(received.single, isA<AckMessage>());
+
+      await sub.cancel();
+      await service.dispose();
+      mgr.dispose();
+    });
+  });
+}
@@ -1,4 +1,5 @@
 import 'package:app/models/server_connection.dart';
+import 'package:app/models/stream_flow.dart';
 import 'package:app/services/connection_manager.dart';
 import 'package:flutter_test/flutter_test.dart';
 
@@ -121,6 +122,36 @@ void main() {
 
       await expectLater(messages, emitsDone);
     });
+
+    // ── flow control ──
+
+    test('flowStats accumulates flow_state reports', () {
+      final mgr = ConnectionManager();
+      expect(mgr.flowStats.value.isVisible, isFalse);
+
+      mgr.ingestRawFrame(
+        '{"type":"flow_state","mode":"sample","coalesced":2,'
+        '"withheld":{"info":5}}',
+      );
+      mgr.ingestRawFrame(
+        '{"type":"flow_state","mode":"sample","coalesced":0,'
+        '"withheld":{"info":3,"debug":1}}',
+      );
+
+      final stats = mgr.flowStats.value;
+      expect(stats.mode, FlowMode.sample);
+      expect(stats.isThrottled, isTrue);
+      expect(stats.coalesced, 2);
+      expect(stats.withheldBySeverity, {'info': 8, 'debug': 1});
+      expect(stats.withheld, 9);
+
+      mgr.ingestRawFrame(
+        '{"type":"flow_state","mode":"live","coalesced":0,"withheld":{}}',
+      );
+      expect(mgr.flowStats.value.isThrottled, isFalse);
+      expect(mgr.flowStats.value.withheld, 9);
+      mgr.dispose();
+    });
   });
 
   group('ServerConnection', () {
@@ -253,6 +253,114 @@ void main() {
       expect(store.getState('unknown'), isEmpty);
     });
 
+    // ── Test 16: historical state never overrides newer state ──
+
+    // Non-override data entries are not stacked, so every version reaches
+    // the state update.
+    test('older history chunks do not overwrite newer state', () {
+      LogEntry state(String id, String ts, dynamic value) => makeTestEntry(
+        id: id,
+        sessionId: 'sess-1',
+        kind: EntryKind.data,
+        key: 'phase',
+        value: value,
+        timestamp: ts,
+        override_: false,
+      );
+
+      // Backfill delivers the newest chunk first.
+      store.insertHistorical([state('h3', '2026-02-07T12:03:00Z', 'done')]);
+      store.insertHistorical([
+        state('h1', '2026-02-07T12:01:00Z', 'start'),
+        state('h2', '2026-02-07T12:02:00Z', 'run'),
+      ]);
+
+      expect(store.getState('sess-1'), {'phase': 'done'});
+      expect(store.entries.map((e) => e.id), ['h1', 'h2', 'h3']);
+    });
+
+    test('history does not overwrite or remove live state', () {
+      store.addEntry(
+        makeTestEntry(
+          id: 'live',
+          kind: EntryKind.data,
+          key: 'phase',
+          value: 'live',
+          timestamp: '2026-02-07T12:05:00Z',
+          override_: false,
+        ),
+      );
+      store.insertHistorical([
+        makeTestEntry(
+          id: 'h1',
+          kind: EntryKind.data,
+          key: 'phase',
+          timestamp: '2026-02-07T12:01:00Z',
+          override_: false,
+        ),
+        makeTestEntry(
+          id: 'h2',
+          kind: EntryKind.data,
+          key: 'other',
+          value: 1,
+          timestamp: '2026-02-07T12:01:00Z',
+          override_: false,
+        ),
+      ]);
+
+      expect(store.getState('sess-1'), {'phase': 'live', 'other': 1});
+    });
+
+    test('history compares state times, not timestamp strings', () {
+      store.addEntry(
+        makeTestEntry(
+          id: 'live',
+          kind: EntryKind.data,
+          key: 'phase',
+          value: 'live',
+          timestamp: '2026-02-07T12:05:00.5Z',
+          override_: false,
+        ),
+      );
+      // Sorts after the live timestamp as a string, but is older.
+      store.insertHistorical([
+        makeTestEntry(
+          id: 'h1',
+          kind: EntryKind.data,
+          key: 'phase',
+          value: 'old',
+          timestamp: '2026-02-07T13:01:00+02:00',
+          override_: false,
+        ),
+      ]);
+
+      expect(store.getState('sess-1'), {'phase': 'live'});
+    });
+
+    // ── Test 17: ingest counters ──
+
+    test('ingest counters count every live version and survive clear', () {
+      store.addEntry(_makeEntry(id: 'e1', severity: Severity.error));
+      store.addEntry(_makeEntry(id: 'e1', replace: true));
+      store.addEntry(_makeEntry(id: 'e2', severity: Severity.critical));
+      store.addEntry(_makeEntry(id: 'e3', severity: Severity.warning));
+      store.clear();
+
+      expect(store.ingestedCount, 4);
+      expect(store.ingestedErrorCount, 2);
+    });
+
+    test('ingest counters skip history', () {
+      store.addEntries([
+        _makeEntry(id: 'h1', severity: Severity.error),
+        _makeEntry(id: 'h2'),
+      ]);
+      store.insertHistorical([_makeEntry(id: 'h0', severity: Severity.error)]);
+
+      expect(store.ingestedCount, 0);
+      expect(store.ingestedErrorCount, 0);
+    });
+
     // ── Eviction tests ──
 
     group('entry cap eviction', () {
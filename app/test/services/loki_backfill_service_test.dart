@@ -0,0 +1,206 @@
+import 'dart:convert';
+
+import 'package:app/services/log_store.dart';
+import 'package:app/services/loki_backfill_service.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+class _FakeLokiBackfillPlatform implements LokiBackfillPlatformApi {
+  final List<({int id, String lokiUrl, String query, int startMs, int endMs})>
+  requests = [];
+  int cancelCalls = 0;
+
+  @override
+  Future<void> backfill({
+    required int id,
+    required String lokiUrl,
+    required String query,
+    required int startMs,
+    required int endMs,
+  }) async {
+    requests.add((
+      id: id,
+      lokiUrl: lokiUrl,
+      query: query,
+      startMs: startMs,
+      endMs: endMs,
+    ));
+  }
+
+  @override
+  Future<void> cancel() async {
+    cancelCalls++;
+  }
+}
+
+String _line(String id, String timestamp) => jsonEncode({
+  'id': id,
+  'timestamp': timestamp,
+  'session_id': 'sess-1',
+  'kind': 'event',
+  'severity': 'info',
+  'message': 'msg $id',
+});
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  group('LokiBackfillService', () {
+    final from = DateTime.utc(2026, 1, 1);
+    final to = DateTime.utc(2026, 1, 2);
+
+    test('forwards the range and selector to the platform', () async {
+      final platform = _FakeLokiBackfillPlatform();
+      final service = LokiBackfillService(
+        logStore: LogStore(),
+        platform: platform,
+      );
+
+      final result = service.backfill(
+        lokiUrl: 'http://127.0.0.1:3999',
+        from: from,
+        to: to,
+        sessionId: 'sess-1',
+      );
+      await Future<void>.delayed(Duration.zero);
+
+      final request = platform.requests.single;
+      expect(request.lokiUrl, 'http://127.0.0.1:3999');
+      expect(request.query, '{app=~".+"} | session="sess-1"');
+      expect(request.startMs, from.millisecondsSinceEpoch);
+      expect(request.endMs, to.millisecondsSinceEpoch);
+      expect(service.running, isTrue);
+
+      await service.handleMethodCall(
+        MethodCall('backfillDone', {'id': request.id, 'count': 0}),
+      );
+      expect(await result, 0);
+      expect(service.running, isFalse);
+      await service.dispose();
+    });
+
+    test('buildQuery filters sessions on structured metadata', () {
+      expect(LokiBackfillService.buildQuery(), '{app=~".+"}');
+      expect(
+        LokiBackfillService.buildQuery(sessionId: r'a"b\c'),
+        r'{app=~".+"} | session="a\"b\\c"',
+      );
+    });
+
+    test('newest-first chunks end up in timestamp order', () async {
+      final platform = _FakeLokiBackfillPlatform();
+      final store = LogStore();
+      final service = LokiBackfillService(logStore: store, platform: platform);
+
+      final result = service.backfill(from: from, to: to);
+      await Future<void>.delayed(Duration.zero);
+      final id = platform.requests.single.id;
+
+      await service.handleMethodCall(
+        MethodCall('backfillEntries', {
+          'id': id,
+          'lines': [
+            _line('c', '2026-01-01T12:00:00.000Z'),
+            _line('d', '2026-01-01T13:00:00.000Z'),
+          ],
+        }),
+      );
+      await service.handleMethodCall(
+        MethodCall('backfillEntries', {
+          'id': id,
+          'lines': [
+            _line('a', '2026-01-01T10:00:00.000Z'),
+            'not json',
+            _line('b', '2026-01-01T11:00:00.000Z'),
+          ],
+        }),
+      );
+      await service.handleMethodCall(
+        MethodCall('backfillDone', {'id': id, 'count': 5}),
+      );
+
+      expect(await result, 4);
+      expect(store.entries.map((e) => e.id), ['a', 'b', 'c', 'd']);
+      await service.dispose();
+    });
+
+    test('stops once the log store is at capacity', () async {
+      final platform = _FakeLokiBackfillPlatform();
+      final store = LogStore();
+      final service = LokiBackfillService(logStore: store, platform: platform);
+
+      final result = service.backfill(from: from, to: to);
+      await Future<void>.delayed(Duration.zero);
+      final id = platform.requests.single.id;
+
+      final lines = [
+        for (var i = 0; i < LogStore.maxEntries; i++)
+          _line('e$i', '2026-01-01T12:00:00.000Z'),
+      ];
+      await service.handleMethodCall(
+        MethodCall('backfillEntries', {'id': id, 'lines': lines}),
+      );
+
+      expect(platform.cancelCalls, 1);
+      expect(service.running, isFalse);
+      expect(await result, LogStore.maxEntries);
+
+      // Chunks still in flight from the cancelled backfill are ignored.
+      await service.handleMethodCall(
+        MethodCall('backfillEntries', {
+          'id': id,
+          'lines': [_line('older', '2026-01-01T10:00:00.000Z')],
+        }),
+      );
+      expect(store.length, LogStore.maxEntries);
+      expect(store.entries.first.id, 'e0');
+      await service.dispose();
+    });
+
+    test('a new backfill supersedes the running one', () async {
+      final platform = _FakeLokiBackfillPlatform();
+      final store = LogStore();
+      final service = LokiBackfillService(logStore: store, platform: platform);
+
+      final first = service.backfill(from: from, to: to);
+      await Future<void>.delayed(Duration.zero);
+      final second = service.backfill(from: from, to: to);
+      await Future<void>.delayed(Duration.zero);
+      expect(await first, 0);
+
+      final staleId = platform.requests.first.id;
+      await service.handleMethodCall(
+        MethodCall('backfillEntries', {
+          'id': staleId,
+          'lines': [_line('stale', '2026-01-01T10:00:00.000Z')],
+        }),
+      );
+      expect(store.entries, isEmpty);
+
+      await service.handleMethodCall(
+        MethodCall('backfillDone', {
+          'id': platform.requests.last.id,
+          'count': 0,
+          'error': 'Loki returned HTTP 502',
+        }),
+      );
+      expect(await second, 0);
+      await service.dispose();
+    });
+
+    test('dispose cancels a running backfill', () async {
+      final platform = _FakeLokiBackfillPlatform();
+      final service = LokiBackfillService(
+        logStore: LogStore(),
+        platform: platform,
+      );
+
+      final result = service.backfill(from: from, to: to);
+      await Future<void>.delayed(Duration.zero);
+      await service.dispose();
+
+      expect(platform.cancelCalls, 1);
+      expect(await result, 0);
+    });
+  });
+}
@@ -123,7 +123,18 @@ void main() {
       expect(store.selectedSessionIds, isEmpty);
     });
 
-    // ── Test 23: getSession returns null for unknown ID ──
+    // ── Test 23: selectSessions replaces the selection ──
+
+    test('selectSessions replaces the selection', () {
+      store.toggleSession('sess-1');
+
+      store.selectSessions({'sess-2', 'sess-3'});
+
+      expect(store.selectedSessionIds, {'sess-2', 'sess-3'});
+      expect(store.isSelected('sess-1'), isFalse);
+    });
+
+    // ── Test 24: getSession returns null for unknown ID ──
 
     test('getSession returns null for unknown ID', () {
       expect(store.getSession('nonexistent'), isNull);
@@ -1,29 +1,46 @@
+import 'package:app/models/log_entry.dart';
 import 'package:app/services/connection_manager.dart';
 import 'package:app/services/log_store.dart';
 import 'package:app/services/settings_service.dart';
 import 'package:app/services/time_range_service.dart';
 import 'package:app/services/tray_service.dart';
+import 'package:app/services/viewer_window_service.dart';
 import 'package:flutter_test/flutter_test.dart';
 
+import '../test_helpers.dart';
+
 class _FakeTrayPlatform implements TrayPlatformApi {
-  final List<({String method, String id, Object value})> calls = [];
+  final List<Map<String, TrayItemState>> batches = [];
+  final List<({int entries, int errors, int connections})> stats = [];
 
   @override
-  Future<void> setChecked({required String id, required bool checked}) async {
-    calls.add((method: 'setChecked', id: id, value: checked));
+  Future<void> applyState(Map<String, TrayItemState> items) async {
+    batches.add(items);
   }
 
   @override
-  Future<void> setEnabled({required String id, required bool enabled}) async {
-    calls.add((method: 'setEnabled', id: id, value: enabled));
+  Future<void> reportStats({
+    required int entries,
+    required int errors,
+    required int connections,
+  }) async {
+    stats.add((entries: entries, errors: errors, connections: connections));
   }
 
-  @override
-  Future<void> setLabel({required String id, required String label}) async {
-    calls.add((method: 'setLabel', id: id, value: label));
+  void clear() {
+    batches.clear();
+    stats.clear();
   }
+}
+
+class _FakeViewerWindowPlatform implements ViewerWindowPlatformApi {
+  final List<bool> opened = [];
 
-  void clear() => calls.clear();
+  @override
+  Future<int?> openView({required bool decorated}) async {
+    opened.add(decorated);
+    return opened.length;
+  }
 }
 
 class _MemoryPrefsStore implements TrayPrefsStore {
@@ -124,14 +141,10 @@ void main() {
 
       expect(opener.opened, [TrayService.grafanaUrl]);
 
-      expect(
-        platform.calls,
-        containsAll(<Matcher>[
-          predicate((c) => c is ({String method, String id, Object value}) && c.method == 'setChecked' && c.id == 'extensions.loki' && c.value == true),
-          predicate((c) => c is ({String method, String id, Object value}) && c.method == 'setEnabled' && c.id == 'extensions.grafana' && c.value == true),
-          predicate((c) => c is ({String method, String id, Object value}) && c.method == 'setChecked' && c.id == 'extensions.grafana' && c.value == true),
-        ]),
-      );
+      expect(platform.batches.last, {
+        'extensions.loki': const TrayItemState(checked: true),
+        'extensions.grafana': const TrayItemState(enabled: true, checked: true),
+      });
 
       await service.dispose();
     });
@@ -163,16 +176,99 @@ void main() {
       expect(prefs.lastSaved!.grafanaEnabled, false);
       expect(opener.opened, isEmpty);
 
+      expect(platform.batches.last, {
+        'extensions.loki': const TrayItemState(checked: false),
+        'extensions.grafana': const TrayItemState(enabled: false, checked: false),
+      });
+
+      await service.dispose();
+    });
+  });
+
+  group('TrayService batched state', () {
+    TrayService build(_FakeTrayPlatform platform, LogStore store) {
+      return TrayService(
+        connectionManager: ConnectionManager(),
+        logStore: store,
+        timeRangeService: TimeRangeService(),
+        settings: SettingsService(),
+        platform: platform,
+        prefsStore: _MemoryPrefsStore(TrayPrefs.defaults),
+        urlOpener: _FakeUrlOpener(),
+        clipboard: _NoopClipboard(),
+        adminApi: _NoopAdminApi(),
+      );
+    }
+
+    test('start syncs every menu item in one batch', () async {
+      final platform = _FakeTrayPlatform();
+      final service = build(platform, LogStore());
+
+      await service.start();
+
+      expect(platform.batches, hasLength(1));
+      final batch = platform.batches.single;
       expect(
-        platform.calls,
-        containsAll(<Matcher>[
-          predicate((c) => c is ({String method, String id, Object value}) && c.method == 'setChecked' && c.id == 'extensions.loki' && c.value == false),
-          predicate((c) => c is ({String method, String id, Object value}) && c.method == 'setEnabled' && c.id == 'extensions.grafana' && c.value == false),
-          predicate((c) => c is ({String method, String id, Object value}) && c.method == 'setChecked' && c.id == 'extensions.grafana' && c.value == false),
-        ]),
+        batch['connection.http_base'],
+        const TrayItemState(label: 'HTTP - http://127.0.0.1:8080', enabled: true),
+      );
+      expect(batch['connection.docs'], const TrayItemState(enabled: true));
+      expect(batch['extensions.loki'], const TrayItemState(checked: false));
+      expect(
+        batch['extensions.grafana'],
+        const TrayItemState(enabled: false, checked: false),
       );
 
       await service.dispose();
     });
+
+    test('reportStats sends cumulative counters only when they change', () async {
+      final platform = _FakeTrayPlatform();
+      final store = LogStore();
+      final service = build(platform, store);
+
+      await service.start();
+      platform.clear();
+
+      await service.reportStats();
+      store.addEntry(makeTestEntry(id: 'a'));
+      store.addEntry(makeTestEntry(id: 'b', severity: Severity.error));
+      store.addEntry(makeTestEntry(id: 'c', severity: Severity.critical));
+      await service.reportStats();
+      await service.reportStats();
+      store.clear();
+      await service.reportStats();
+
+      expect(platform.stats, [
+        (entries: 0, errors: 0, connections: 0),
+        (entries: 3, errors: 2, connections: 0),
+      ]);
+
+      await service.dispose();
+    });
+  });
+
+  group('TrayService windows', () {
+    test('New window opens a view matching the mini mode decoration', () async {
+      final windowPlatform = _FakeViewerWindowPlatform();
+      final settings = SettingsService();
+
+      final service = TrayService(
+        connectionManager: ConnectionManager(),
+        logStore: LogStore(),
+        timeRangeService: TimeRangeService(),
+        settings: settings,
+        platform: _FakeTrayPlatform(),
+        prefsStore: _MemoryPrefsStore(TrayPrefs.defaults),
+        urlOpener: _FakeUrlOpener(),
+        clipboard: _NoopClipboard(),
+        adminApi: _NoopAdminApi(),
+        viewerWindows: ViewerWindowService(platform: windowPlatform),
+      );
+
+      await service.handleAction(id: 'window.new');
+
+      expect(windowPlatform.opened, [!settings.miniMode]);
+    });
   });
 }
@@ -0,0 +1,71 @@
+import 'package:app/services/viewer_window_service.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+class _FakeViewerWindowPlatform implements ViewerWindowPlatformApi {
+  final List<bool> opened = [];
+  int nextViewId = 1;
+  Object? error;
+
+  @override
+  Future<int?> openView({required bool decorated}) async {
+    if (error != null) throw error!;
+    opened.add(decorated);
+    return nextViewId++;
+  }
+}
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  group('ViewerWindowService', () {
+    test('openWindow hands the config to the new view once', () async {
+      final platform = _FakeViewerWindowPlatform();
+      final service = ViewerWindowService(platform: platform);
+      var notified = 0;
+      service.addListener(() => notified++);
+
+      final viewId = await service.openWindow(
+        config: const ViewerWindowConfig(
+          textFilter: 'timeout',
+          severities: {'error', 'critical'},
+          sessionIds: {'sess-2'},
+        ),
+        decorated: false,
+      );
+
+      expect(viewId, 1);
+      expect(platform.opened, [false]);
+      expect(notified, 1);
+
+      final config = service.takeConfig(1);
+      expect(config?.textFilter, 'timeout');
+      expect(config?.severities, {'error', 'critical'});
+      expect(config?.sessionIds, {'sess-2'});
+      expect(service.takeConfig(1), isNull);
+    });
+
+    test('views opened natively have no pending config', () {
+      final service = ViewerWindowService(
+        platform: _FakeViewerWindowPlatform(),
+      );
+      expect(service.takeConfig(7), isNull);
+    });
+
+    test('openWindow returns null without a native implementation', () async {
+      final platform = _FakeViewerWindowPlatform()
+        ..error = MissingPluginException();
+      final service = ViewerWindowService(platform: platform);
+
+      expect(await service.openWindow(), isNull);
+    });
+
+    test('openWindow returns null when the platform refuses', () async {
+      final platform = _FakeViewerWindowPlatform()
+        ..error = PlatformException(code: 'unavailable');
+      final service = ViewerWindowService(platform: platform);
+
+      expect(await service.openWindow(), isNull);
+    });
+  });
+}
@@ -55,5 +55,22 @@ void main() {
       await tester.pumpWidget(_wrap());
       expect(find.byIcon(Icons.memory_outlined), findsOneWidget);
     });
+
+    testWidgets('hides stream sampling until the server throttles', (
+      tester,
+    ) async {
+      final connMgr = ConnectionManager();
+      await tester.pumpWidget(_wrap(connMgr: connMgr));
+      expect(find.byIcon(Icons.filter_alt_outlined), findsNothing);
+
+      connMgr.ingestRawFrame(
+        '{"type":"flow_state","mode":"sample","coalesced":0,'
+        '"withheld":{"debug":1500}}',
+      );
+      await tester.pump();
+
+      expect(find.byIcon(Icons.filter_alt_outlined), findsOneWidget);
+      expect(find.text('sampling \u00b7 1.5k withheld'), findsOneWidget);
+    });
   });
 }
@@ -1,7 +1,7 @@
 import type { StoredEntry } from '@logger/shared';
 import type { ServerWebSocket } from 'bun';
-import { describe, expect, it } from 'bun:test';
-import { WebSocketHub } from './ws-hub';
+import { afterEach, describe, expect, it, setSystemTime } from 'bun:test';
+import { selectFlowMode, WebSocketHub } from './ws-hub';
 
 // ─── Mock WebSocket ──────────────────────────────────────────────────
 
@@ -19,6 +19,9 @@ class MockWebSocket {
 /** Wait for the 16ms WS broadcast flush interval to complete. */
 const flushBuffers = () => new Promise(resolve => setTimeout(resolve, 20))
 
+/** Move the clock past the flow-control report lag. */
+const outlastReportLag = () => setSystemTime(new Date(Date.now() + 1_000))
+
 function makeLogMessage(overrides: Partial<StoredEntry> & { id: string }): Record<string, unknown> {
   return {
     type: 'event',
@@ -211,3 +214,131 @@ describe('WebSocketHub', () => {
     expect(mock.sent[0].entry.id).toBe('e1')
   })
 })
+
+// ─── Flow control ────────────────────────────────────────────────────
+
+describe('WebSocketHub flow control', () => {
+  afterEach(() => setSystemTime())
+
+  /** A viewer that has `backlog` events overdue when it first reports. */
+  async function setup(backlog: number) {
+    const hub = new WebSocketHub()
+    const ws = new MockWebSocket() as unknown as ServerWebSocket<any>
+    const mock = ws as unknown as MockWebSocket
+    hub.addViewer(ws)
+    for (let i = 0; i < backlog; i++) hub.broadcast(makeLogMessage({ id: `backlog${i}` }))
+    await flushBuffers()
+    outlastReportLag()
+    mock.sent = []
+    hub.handleViewerMessage(ws, { type: 'flow_control', consumed: 0 })
+    return { hub, ws, mock }
+  }
+
+  const events = (mock: MockWebSocket) => mock.sent.filter((m) => m.type === 'event')
+  const flowStates = (mock: MockWebSocket) => mock.sent.filter((m) => m.type === 'flow_state')
+
+  it('selects modes by backlog and steps down only after it halves', () => {
+    expect(selectFlowMode('live', 100)).toBe('live')
+    expect(selectFlowMode('live', 500)).toBe('coalesce')
+    expect(selectFlowMode('live', 2_000)).toBe('sample')
+    expect(selectFlowMode('live', 10_000)).toBe('summary')
+
+    expect(selectFlowMode('sample', 1_500)).toBe('sample')
+    expect(selectFlowMode('sample', 900)).toBe('coalesce')
+    expect(selectFlowMode('summary', 0)).toBe('live')
+  })
+
+  it('stays live for viewers that report a small backlog', async () => {
+    const { hub, mock } = await setup(10)
+
+    for (let i = 0; i < 20; i++) hub.broadcast(makeLogMessage({ id: `e${i}`, severity: 'debug' }))
+    await flushBuffers()
+
+    expect(events(mock)).toHaveLength(20)
+    expect(flowStates(mock)).toHaveLength(0)
+  })
+
+  it('coalesces replace updates to the newest version', async () => {
+    const { hub, mock } = await setup(600)
+    expect(flowStates(mock)[0].mode).toBe('coalesce')
+
+    for (let v = 0; v < 5; v++) {
+      hub.broadcast(makeLogMessage({ id: 'progress', replace: true, message: `v${v}` }))
+    }
+    hub.broadcast(makeLogMessage({ id: 'other' }))
+    await flushBuffers()
+
+    expect(events(mock).map((m) => m.entry.message)).toEqual(['v4', 'hello'])
+    expect(flowStates(mock).at(-1).coalesced).toBe(4)
+  })
+
+  it('samples low-severity entries but never drops warnings or errors', async () => {
+    const { hub, mock } = await setup(3_000)
+    expect(flowStates(mock)[0].mode).toBe('sample')
+
+    for (let i = 0; i < 20; i++) hub.broadcast(makeLogMessage({ id: `i${i}`, severity: 'info' }))
+    hub.broadcast(makeLogMessage({ id: 'w1', severity: 'warning' }))
+    hub.broadcast(makeLogMessage({ id: 'err1', severity: 'error', replace: true }))
+    hub.broadcast(makeLogMessage({ id: 'err1', severity: 'error', replace: true }))
+    await flushBuffers()
+
+    const ids = events(mock).map((m) => m.entry.id)
+    expect(ids.filter((id) => id.startsWith('i'))).toHaveLength(2)
+    expect(ids.filter((id) => id === 'w1')).toHaveLength(1)
+    expect(ids.filter((id) => id === 'err1')).toHaveLength(2)
+    expect(flowStates(mock).at(-1).withheld).toEqual({ info: 18 })
+  })
+
+  it('summarizes everything below error and recovers once the viewer catches up', async () => {
+    const { hub, ws, mock } = await setup(20_000)
+    expect(flowStates(mock)[0].mode).toBe('summary')
+
+    hub.broadcast(makeLogMessage({ id: 'd1', severity: 'debug' }))
+    hub.broadcast(makeLogMessage({ id: 'w1', severity: 'warning' }))
+    hub.broadcast(makeLogMessage({ id: 'c1', severity: 'critical' }))
+    await flushBuffers()
+
+    expect(events(mock).map((m) => m.entry.id)).toEqual(['c1'])
+    expect(flowStates(mock).at(-1).withheld).toEqual({ debug: 1, warning: 1 })
+
+    hub.handleViewerMessage(ws, { type: 'flow_control', consumed: 20_001 })
+    expect(flowStates(mock).at(-1).mode).toBe('live')
+  })
+
+  it('counts the backlog from the first event, before any report', async () => {
+    const hub = new WebSocketHub()
+    const ws = new MockWebSocket() as unknown as ServerWebSocket<any>
+    const mock = ws as unknown as MockWebSocket
+    hub.addViewer(ws)
+
+    for (let i = 0; i < 3_000; i++) hub.broadcast(makeLogMessage({ id: `e${i}` }))
+    await flushBuffers()
+    expect(events(mock)).toHaveLength(3_000)
+    outlastReportLag()
+
+    // The viewer has handled 200 events; 2,800 are overdue.
+    hub.handleViewerMessage(ws, { type: 'flow_control', consumed: 200 })
+    expect(flowStates(mock).at(-1).mode).toBe('sample')
+
+    hub.handleViewerMessage(ws, { type: 'flow_control', consumed: 3_000 })
+    expect(flowStates(mock).at(-1).mode).toBe('live')
+  })
+
+  it('does not count events sent within the report lag', async () => {
+    const hub = new WebSocketHub()
+    const ws = new MockWebSocket() as unknown as ServerWebSocket<any>
+    const mock = ws as unknown as MockWebSocket
+    hub.addViewer(ws)
+
+    // A fast stream the viewer has not had time to report on yet.
+    for (let i = 0; i < 3_000; i++) hub.broadcast(makeLogMessage({ id: `e${i}` }))
+    await flushBuffers()
+    hub.handleViewerMessage(ws, { type: 'flow_control', consumed: 0 })
+    expect(flowStates(mock)).toHaveLength(0)
+
+    // Still unprocessed once the lag has passed: the viewer is behind.
+    outlastReportLag()
+    hub.handleViewerMessage(ws, { type: 'flow_control', consumed: 0 })
+    expect(flowStates(mock).at(-1).mode).toBe('sample')
+  })
+})
@@ -1,4 +1,4 @@
-import { ViewerCommand, type ServerBroadcast, type SeverityLevel } from '@logger/shared';
+import { ViewerCommand, type FlowMode, type ServerBroadcast, type SeverityLevel, type StoredEntry } from '@logger/shared';
 import type { ServerWebSocket } from 'bun';
 import type { WsData } from '../transport/types';
 
@@ -11,11 +11,36 @@ export interface ViewerSubscription {
   textFilter?: string
 }
 
+interface BufferedEvent {
+  data: string
+  entry: StoredEntry
+}
+
+/** Flow-control state; only present once a viewer has reported consumption. */
+interface ViewerFlow {
+  /** `event` messages the viewer reports as processed */
+  consumed: number
+  mode: FlowMode
+  /** Mode last announced to the viewer via `flow_state` */
+  announcedMode: FlowMode
+  sampleCounter: number
+}
+
+interface SentSample {
+  at: number
+  sent: number
+}
+
 interface ViewerEntry {
   ws: ServerWebSocket<WsData>
   subscription: ViewerSubscription
-  buffer: string[]
+  buffer: BufferedEvent[]
   flushTimer: Timer | null
+  /** `event` messages sent since the socket opened; the viewer counts from the same point. */
+  sent: number
+  /** `sent` after recent flushes, oldest first; only kept for the report lag window. */
+  sentLog: SentSample[]
+  flow: ViewerFlow | null
 }
 
 // ─── Severity ordering for filter comparison ─────────────────────────
@@ -28,6 +53,53 @@ const SEVERITY_ORDER: Record<string, number> = {
   critical: 4,
 }
 
+// ─── Flow control ────────────────────────────────────────────────────
+
+/** Backlog (events in flight to a viewer) at which each throttling mode kicks in. */
+const FLOW_LEVELS: { mode: FlowMode; enter: number }[] = [
+  { mode: 'coalesce', enter: 500 },
+  { mode: 'sample', enter: 2_000 },
+  { mode: 'summary', enter: 10_000 },
+]
+
+const FLOW_RANK: Record<FlowMode, number> = { live: 0, coalesce: 1, sample: 2, summary: 3 }
+
+/** In `sample` mode one in this many debug/info events is still delivered. */
+const SAMPLE_EVERY = 10
+
+/**
+ * How far a viewer's `consumed` count may trail what was sent: it reports every
+ * 250 ms, so events sent within two report intervals are expected in flight.
+ */
+const FLOW_REPORT_LAG_MS = 500
+
+/** Pick the mode for a backlog; stepping down waits until the backlog halves. */
+export function selectFlowMode(current: FlowMode, backlog: number): FlowMode {
+  let target: FlowMode = 'live'
+  for (const level of FLOW_LEVELS) {
+    if (backlog >= level.enter) target = level.mode
+  }
+  if (FLOW_RANK[target] >= FLOW_RANK[current]) return target
+
+  const exitBelow = FLOW_LEVELS[FLOW_RANK[current] - 1]!.enter / 2
+  return backlog < exitBelow ? target : current
+}
+
+/** Errors, criticals and session lifecycle entries are never coalesced or withheld. */
+function isProtected(entry: StoredEntry): boolean {
+  return entry.kind === 'session' || SEVERITY_ORDER[entry.severity]! >= SEVERITY_ORDER.error!
+}
+
+/** Key under which newer versions supersede older ones, mirroring viewer stacking. */
+function coalesceKey(entry: StoredEntry): string | null {
+  if (isProtected(entry)) return null
+  if (entry.kind === 'event' && entry.replace) return `${entry.session_id}::${entry.id}`
+  if (entry.kind === 'data' && entry.key !== null && entry.override) {
+    return `${entry.session_id}::data::${entry.key}`
+  }
+  return null
+}
+
 // ─── WebSocket Hub ───────────────────────────────────────────────────
 
 export class WebSocketHub {
@@ -40,6 +112,9 @@ export class WebSocketHub {
       subscription: { sessionIds: [] },
       buffer: [],
       flushTimer: null,
+      sent: 0,
+      sentLog: [],
+      flow: null,
     })
   }
 
@@ -78,7 +153,7 @@ export class WebSocketHub {
       if (!this.matchesSubscription(message, entry.subscription)) continue
 
       if (message.type === 'event') {
-        entry.buffer.push(data)
+        entry.buffer.push({ data, entry: message.entry })
         if (!entry.flushTimer) {
           entry.flushTimer = setTimeout(() => this.flushViewer(entry), 16)
         }
@@ -93,15 +168,123 @@ export class WebSocketHub {
     entry.flushTimer = null
     if (entry.buffer.length === 0) return
 
-    const messages = entry.buffer
+    let events = entry.buffer
     entry.buffer = []
 
-    for (const msg of messages) {
-      entry.ws.send(msg)
+    const flow = entry.flow
+    let coalesced = 0
+    const withheld: Record<string, number> = {}
+    if (flow) {
+      flow.mode = selectFlowMode(flow.mode, this.backlog(entry, flow))
+      if (flow.mode !== 'live') {
+        const before = events.length
+        events = this.coalesce(events)
+        coalesced = before - events.length
+        events = this.thin(events, flow, withheld)
+      }
+    }
+
+    for (const event of events) {
+      entry.ws.send(event.data)
+    }
+    entry.sent += events.length
+    entry.sentLog.push({ at: Date.now(), sent: entry.sent })
+    this.settledSent(entry) // drops superseded samples
+
+    if (flow) {
+      if (coalesced > 0 || Object.keys(withheld).length > 0 || flow.mode !== flow.announcedMode) {
+        this.sendFlowState(entry, flow, coalesced, withheld)
+      }
     }
   }
 
-  /** Process an incoming viewer message (subscribe/unsubscribe). */
+  /** Keep only the newest version of each replace/stack update, in its latest position. */
+  private coalesce(events: BufferedEvent[]): BufferedEvent[] {
+    const seen = new Set<string>()
+    const kept: BufferedEvent[] = []
+    for (let i = events.length - 1; i >= 0; i--) {
+      const key = coalesceKey(events[i]!.entry)
+      if (key !== null) {
+        if (seen.has(key)) continue
+        seen.add(key)
+      }
+      kept.push(events[i]!)
+    }
+    return kept.reverse()
+  }
+
+  /** Sample (`sample`) or withhold (`summary`) low-severity events, counting what was dropped. */
+  private thin(events: BufferedEvent[], flow: ViewerFlow, withheld: Record<string, number>): BufferedEvent[] {
+    if (flow.mode !== 'sample' && flow.mode !== 'summary') return events
+
+    const kept: BufferedEvent[] = []
+    for (const event of events) {
+      const e = event.entry
+      const severity = SEVERITY_ORDER[e.severity] ?? 0
+      let keep = true
+      if (e.kind === 'event' && !isProtected(e)) {
+        if (flow.mode === 'summary') {
+          keep = false
+        } else if (severity < SEVERITY_ORDER.warning!) {
+          keep = flow.sampleCounter++ % SAMPLE_EVERY === 0
+        }
+      }
+
+      if (keep) {
+        kept.push(event)
+      } else {
+        withheld[e.severity] = (withheld[e.severity] ?? 0) + 1
+      }
+    }
+    return kept
+  }
+
+  private sendFlowState(
+    entry: ViewerEntry,
+    flow: ViewerFlow,
+    coalesced: number,
+    withheld: Record<string, number>,
+  ): void {
+    flow.announcedMode = flow.mode
+    entry.ws.send(JSON.stringify({ type: 'flow_state', mode: flow.mode, coalesced, withheld }))
+  }
+
+  /** Record a viewer's consumption report and re-evaluate its flow mode. */
+  private handleFlowControl(entry: ViewerEntry, consumed: number): void {
+    const flow = entry.flow ??= {
+      consumed: 0,
+      mode: 'live',
+      announcedMode: 'live',
+      sampleCounter: 0,
+    }
+    // A viewer can never have processed more than it was sent.
+    flow.consumed = Math.min(consumed, entry.sent)
+
+    flow.mode = selectFlowMode(flow.mode, this.backlog(entry, flow))
+    if (flow.mode !== flow.announcedMode) {
+      this.sendFlowState(entry, flow, 0, {})
+    }
+  }
+
+  /**
+   * Events the viewer should have processed by now but has not. Events sent
+   * within the report lag are excluded, so a viewer keeping up with a high
+   * ingest rate is not mistaken for one falling behind.
+   */
+  private backlog(entry: ViewerEntry, flow: ViewerFlow): number {
+    return Math.max(0, this.settledSent(entry) - flow.consumed)
+  }
+
+  /** `event` messages sent at least the report lag ago. */
+  private settledSent(entry: ViewerEntry): number {
+    const settledBefore = Date.now() - FLOW_REPORT_LAG_MS
+    const log = entry.sentLog
+    // Older samples are superseded once a newer one has settled.
+    while (log.length > 1 && log[1]!.at <= settledBefore) log.shift()
+    return log.length > 0 && log[0]!.at <= settledBefore ? log[0]!.sent : 0
+  }
+
+  /** Process an incoming viewer message (subscribe/unsubscribe/flow_control). */
   handleViewerMessage(ws: ServerWebSocket<WsData>, raw: unknown): void {
     const parsed = ViewerCommand.safeParse(raw)
     if (!parsed.success) {
@@ -124,6 +307,11 @@ export class WebSocketHub {
         this.setSubscription(ws, { sessionIds: [] })
         break
       }
+      case 'flow_control': {
+        const entry = this.viewers.get(ws)
+        if (entry) this.handleFlowControl(entry, message.consumed)
+        break
+      }
       // Other message types (history, rpc_request, etc.) are handled
       // by other modules; this hub only processes subscription management.
     }
@@ -180,7 +180,7 @@ export function setupWebSocket(deps: ServerDeps) {
       return
     }
 
-    // subscribe/unsubscribe handled by ws-hub
+    // subscribe/unsubscribe/flow_control handled by ws-hub
     wsHub.handleViewerMessage(ws, parsed)
   }
 
@@ -38,6 +38,7 @@ export {
 
 export {
     DataState,
+    FlowMode,
     ServerBroadcast,
     SessionInfo
 } from './server-broadcast'
@@ -26,6 +26,9 @@ export const DataState = z.object({
   updated_at: z.string().datetime({ offset: true }),
 })
 
+/** How the server currently throttles the live stream for a viewer. */
+export const FlowMode = z.enum(['live', 'coalesce', 'sample', 'summary'])
+
 // ─── ServerBroadcast (discriminated union) ───────────────────────────
 
 export const ServerBroadcast = z.discriminatedUnion('type', [
@@ -70,6 +73,14 @@ export const ServerBroadcast = z.discriminatedUnion('type', [
     entry_id: z.string().optional(),
   }),
   z.object({ type: z.literal('subscribe_ack') }),
+  z.object({
+    type: z.literal('flow_state'),
+    mode: FlowMode,
+    /** Replace/stack updates superseded by a newer version since the last flow_state */
+    coalesced: z.number().int(),
+    /** Entries withheld by sampling or summarizing since the last flow_state, per severity */
+    withheld: z.record(z.string(), z.number().int()),
+  }),
   z.object({
     type: z.literal('rpc_request'),
     rpc_id: z.string(),
@@ -87,3 +98,4 @@ export const ServerBroadcast = z.discriminatedUnion('type', [
 export type ServerBroadcast = z.infer<typeof ServerBroadcast>
 export type SessionInfo = z.infer<typeof SessionInfo>
 export type DataState = z.infer<typeof DataState>
+export type FlowMode = z.infer<typeof FlowMode>
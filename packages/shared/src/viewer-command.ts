@@ -40,6 +40,11 @@ export const ViewerCommand = z.discriminatedUnion('type', [
     type: z.literal('data_query'),
     session_id: z.string(),
   }),
+  z.object({
+    type: z.literal('flow_control'),
+    /** Total `event` messages the viewer has processed on this connection */
+    consumed: z.number().int().min(0),
+  }),
 ])
 
 export type ViewerCommand = z.infer<typeof ViewerCommand>
@@ -23,6 +23,7 @@ describe('protocol fixtures', () => {
     'broadcast_rpc_request.json',
     'broadcast_rpc_response.json',
     'broadcast_subscribe_ack.json',
+    'broadcast_flow_state.json',
   ]
 
   for (const fixture of broadcastFixtures) {
@@ -40,6 +41,7 @@ describe('protocol fixtures', () => {
     'command_subscribe.json',
     'command_unsubscribe.json',
     'command_history.json',
+    'command_flow_control.json',
   ]
 
   for (const fixture of commandFixtures) {
@@ -0,0 +1,108 @@
+#!/usr/bin/env bun
+/**
+ * fake-loki.ts
+ *
+ * Minimal Loki `query_range` endpoint for exercising the viewer's native
+ * history backfill without a real Loki. Serves a deterministic set of
+ * entries spread over a time window, honours start/end/limit/direction, and
+ * logs every request so shard parallelism and cache hits are visible.
+ *
+ * Usage:
+ *   bun run scripts/fake-loki.ts
+ *   bun run scripts/fake-loki.ts --port=3999 --hours=24 --rate=2 --delay=200
+ *
+ * Then enable Extensions → Loki in the tray, or point the backfill at
+ * http://127.0.0.1:<port>.
+ */
+
+// ─── Configuration ───────────────────────────────────────────────────
+
+function arg(name: string, fallback: number): number {
+  const prefix = `--${name}=`
+  const raw = process.argv.find((a) => a.startsWith(prefix))
+  return raw ? Number(raw.slice(prefix.length)) : fallback
+}
+
+const PORT = arg('port', 3100)
+const HOURS = arg('hours', 24)
+const RATE_PER_SECOND = arg('rate', 1)
+const DELAY_MS = arg('delay', 0)
+
+const NS_PER_MS = 1_000_000n
+const STEP_NS = BigInt(Math.round(1e9 / RATE_PER_SECOND))
+const END_NS = BigInt(Date.now()) * NS_PER_MS
+const START_NS = END_NS - BigInt(HOURS * 3600 * 1000) * NS_PER_MS
+
+// ─── Data ────────────────────────────────────────────────────────────
+
+const SEVERITIES = ['debug', 'info', 'info', 'warning', 'error'] as const
+
+function lineAt(ts: bigint): string {
+  const n = (ts - START_NS) / STEP_NS
+  return JSON.stringify({
+    id: `fake-loki-${n}`,
+    timestamp: new Date(Number(ts / NS_PER_MS)).toISOString(),
+    session_id: `fake-session-${n % 3n}`,
+    kind: 'event',
+    severity: SEVERITIES[Number(n % BigInt(SEVERITIES.length))],
+    message: `fake loki entry #${n}`,
+  })
+}
+
+// Entries lie on a fixed grid, so any range can be generated on demand.
+function queryRange(start: bigint, end: bigint, limit: number, forward: boolean): [string, string][] {
+  const first = start <= START_NS ? START_NS : START_NS + ((start - START_NS + STEP_NS - 1n) / STEP_NS) * STEP_NS
+  const last = end > END_NS ? END_NS : START_NS + ((end - START_NS) / STEP_NS) * STEP_NS
+  const values: [string, string][] = []
+  if (first > last) return values
+
+  if (forward) {
+    for (let ts = first; ts <= last && values.length < limit; ts += STEP_NS) {
+      values.push([String(ts), lineAt(ts)])
+    }
+  } else {
+    for (let ts = last; ts >= first && values.length < limit; ts -= STEP_NS) {
+      values.push([String(ts), lineAt(ts)])
+    }
+  }
+  return values
+}
+
+// ─── Server ──────────────────────────────────────────────────────────
+
+let inFlight = 0
+
+Bun.serve({
+  port: PORT,
+  hostname: '127.0.0.1',
+  async fetch(req) {
+    const url = new URL(req.url)
+    if (url.pathname === '/ready') return new Response('ready')
+    if (url.pathname !== '/loki/api/v1/query_range') {
+      return new Response('not found', { status: 404 })
+    }
+
+    const start = BigInt(url.searchParams.get('start') ?? String(START_NS))
+    const end = BigInt(url.searchParams.get('end') ?? String(END_NS))
+    const limit = Number(url.searchParams.get('limit') ?? 100)
+    const forward = url.searchParams.get('direction') === 'FORWARD'
+
+    inFlight++
+    console.log(`[fake-loki] query_range start=${start} end=${end} limit=${limit} in-flight=${inFlight}`)
+    try {
+      if (DELAY_MS > 0) await Bun.sleep(DELAY_MS)
+      const values = queryRange(start, end, limit, forward)
+      return Response.json({
+        status: 'success',
+        data: {
+          resultType: 'streams',
+          result: values.length > 0 ? [{ stream: { app: 'fake-loki' }, values }] : [],
+        },
+      })
+    } finally {
+      inFlight--
+    }
+  },
+})
+
+console.log(`[fake-loki] serving ${HOURS}h at ${RATE_PER_SECOND}/s on http://127.0.0.1:${PORT}`)